@@ -0,0 +1,389 @@
+#include "global.h"
+#include "board.h"
+#include "move.h"
+#include "search.h"
+#include "analysis.h"
+#include "hexthello.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <unistd.h>
+#include <pthread.h>
+
+
+/* Analyse: the best moves of a set of positions with their exact values and principal variations.
+ *
+ * The positions are read from a file (-f) or from the standard input, one per line in text form (see
+ * positionFromText(), anything after the position is ignored) or, with -r, as binary records of
+ * POSITION_RECORD_SIZE bytes one after the other (see positionFromRecord(), the form the server sends).
+ * The -k best moves of every position are searched to -d plies, or as deep as -m ms allow (see
+ * analysePosition()), by -j threads at once, each with its own engine. The results are written to -o
+ * file or the standard output as soon as the positions before them are done, in the order of the input,
+ * one move per line:
+ *
+ *     <position number> <rank> <move> <score> <principal variation>
+ *
+ * with the line number of a text position or the number of a record (from 1), the moves as row,col,
+ * "pass" for a null move, and the score for the player to move. A position where the player to move
+ * cannot play gets one line with rank 0 and the move "none". Lines starting with # are comments, the
+ * totals are written last as one of them.
+ *
+ * Every position starts with an empty transposition table, so without -m the results do not depend
+ * on the number of threads or on the other positions of the input. */
+
+#define MAX_LINE 1024
+#define MAX_THREADS 256
+
+/* Default size of the table of each thread in MB. It is cleared for every position, a small one clears
+ * fast and stays in the cache, and one position does not need more */
+#define ANALYSE_DEFAULT_MB 2
+
+/* Positions read ahead of the output for each thread, a slow one does not stop the others */
+#define JOBS_PER_THREAD 16
+
+/* One position on its way from the input to the output */
+typedef struct
+{
+	Position pos;
+	int number;				//line or record of the input
+	int valid;				//FALSE if it could not be read, it is reported instead of analysed
+	int found;				//lines found by the analysis
+	int done;
+	AnalysisLine lines[ MAX_ANALYSIS_LINES ];
+	SearchReport report;
+} Job;
+
+/* The jobs are a ring: the reader fills them, the workers analyse them and the writer writes them out,
+ * all three in the order of the input. readCount - writtenCount jobs are in use, at most ringSize */
+static Job * jobs;
+static int ringSize;
+static long long readCount, takenCount, writtenCount;
+static int endOfInput = FALSE;
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t changed = PTHREAD_COND_INITIALIZER;
+
+/* what every position gets (-d, -m, -k) */
+static int depth = 0;
+static int timeLimitMs = 0;
+static int lineCount = 3;
+
+static const char * inputName = "stdin";
+static FILE * out;
+
+/* totals, kept by the writer */
+static long long positions = 0;
+static int errors = 0;
+static SearchStats total;
+
+
+/**********************************************************/
+/* Worker: takes the oldest job nobody took yet and analyses it, until the input ends */
+static void * analyseJobs( void * arg )
+{
+	HexEngine * engine = ( HexEngine * ) arg;
+	Job * job;
+
+	pthread_mutex_lock( &lock );
+	for( ;; )
+	{
+		while( takenCount == readCount && !endOfInput )
+			pthread_cond_wait( &changed, &lock );
+		if( takenCount == readCount )
+			break;
+		job = &jobs[ takenCount++ % ringSize ];
+		pthread_mutex_unlock( &lock );
+
+		if( job->valid )
+		{
+			hexEngineClear( engine );
+			job->found = hexAnalyse( engine, &job->pos, job->pos.turn, depth, timeLimitMs, lineCount, job->lines, &job->report );
+		}
+
+		pthread_mutex_lock( &lock );
+		job->done = TRUE;
+		pthread_cond_broadcast( &changed );
+	}
+	pthread_mutex_unlock( &lock );
+
+	return NULL;
+}
+
+/**********************************************************/
+static void writeMove( Move * move )
+{
+	if( move->tile[ 0 ] == NULL_MOVE )
+		fprintf( out, " pass" );
+	else
+		fprintf( out, " %d,%d", move->tile[ 0 ], move->tile[ 1 ] );
+}
+
+/**********************************************************/
+static void writeJob( Job * job )
+{
+	int i, j;
+
+	if( !job->valid )
+	{
+		fprintf( out, "# %s:%d: not a valid position\n", inputName, job->number );
+		errors++;
+		return;
+	}
+
+	positions++;
+	addSearchStats( &total, &job->report.stats );
+
+	if( job->found == 0 )
+		fprintf( out, "%d 0 none\n", job->number );
+
+	for( i = 0; i < job->found; i++ )
+	{
+		fprintf( out, "%d %d", job->number, i + 1 );
+		writeMove( &job->lines[ i ].move );
+		fprintf( out, " %+d", job->lines[ i ].score );
+		for( j = 0; j < job->lines[ i ].pvLength; j++ )
+			writeMove( &job->lines[ i ].pv[ j ] );
+		fprintf( out, "\n" );
+	}
+}
+
+/**********************************************************/
+/* TRUE if the writer has something to do: the oldest job is done, or nothing is left (called with the lock held) */
+static int canWrite( void )
+{
+	return writtenCount < readCount ? jobs[ writtenCount % ringSize ].done : endOfInput;
+}
+
+/**********************************************************/
+/* Writer: writes the oldest job as soon as it is done, until the input ends and every job is written.
+ * The output is flushed whenever the writer has to wait, so it follows the analysis */
+static void * writeJobs( void * arg )
+{
+	Job * job;
+
+	pthread_mutex_lock( &lock );
+	for( ;; )
+	{
+		while( !canWrite() )
+		{
+			pthread_mutex_unlock( &lock );
+			fflush( out );
+			pthread_mutex_lock( &lock );
+			if( !canWrite() )
+				pthread_cond_wait( &changed, &lock );
+		}
+		if( writtenCount == readCount )
+			break;
+		job = &jobs[ writtenCount % ringSize ];
+		pthread_mutex_unlock( &lock );
+
+		writeJob( job );
+
+		pthread_mutex_lock( &lock );
+		writtenCount++;
+		pthread_cond_broadcast( &changed );
+	}
+	pthread_mutex_unlock( &lock );
+
+	return NULL;
+}
+
+/**********************************************************/
+/* Reads the next position of the input into job, returns FALSE at the end of the input */
+static int readJob( FILE * in, int records, Job * job, int * number )
+{
+	char line[ MAX_LINE ];
+	char record[ POSITION_RECORD_SIZE ];
+	size_t got;
+
+	if( records )
+	{
+		if( ( got = fread( record, 1, POSITION_RECORD_SIZE, in ) ) == 0 )
+			return FALSE;
+		job->number = ++*number;
+		job->valid = got == POSITION_RECORD_SIZE && positionFromRecord( &job->pos, record );
+		return TRUE;
+	}
+
+	while( fgets( line, MAX_LINE, in ) != NULL )
+	{
+		++*number;
+
+		if( line[ 0 ] == '#' || line[ strspn( line, " \t\r\n" ) ] == '\0' )
+			continue;
+
+		job->number = *number;
+		job->valid = positionFromText( &job->pos, line ) > 0;
+		return TRUE;
+	}
+	return FALSE;
+}
+
+/**********************************************************/
+/* Reader: fills the free jobs with the positions of the input, then tells the others it ended */
+static void readJobs( FILE * in, int records )
+{
+	Job * job;
+	int number = 0;
+
+	for( ;; )
+	{
+		pthread_mutex_lock( &lock );
+		while( readCount - writtenCount == ringSize )
+			pthread_cond_wait( &changed, &lock );
+		job = &jobs[ readCount % ringSize ];
+		pthread_mutex_unlock( &lock );
+
+		//the job is free, nobody else looks at it until readCount passes it
+		if( !readJob( in, records, job, &number ) )
+			break;
+		job->done = FALSE;
+
+		pthread_mutex_lock( &lock );
+		readCount++;
+		pthread_cond_broadcast( &changed );
+		pthread_mutex_unlock( &lock );
+	}
+
+	pthread_mutex_lock( &lock );
+	endOfInput = TRUE;
+	pthread_cond_broadcast( &changed );
+	pthread_mutex_unlock( &lock );
+}
+
+/**********************************************************/
+int main( int argc, char **argv )
+{
+	int c, i;
+	int threads = ( int ) sysconf( _SC_NPROCESSORS_ONLN );
+	int hashSizeMB = ANALYSE_DEFAULT_MB;
+	int records = FALSE;
+	char * fileName = NULL;
+	char * outName = NULL;
+	FILE * in = stdin;
+	HexEngine * engines[ MAX_THREADS ];
+	pthread_t workers[ MAX_THREADS ];
+	pthread_t writer;
+	int started = 0;
+	double seconds;
+
+	opterr = 0;
+
+	while( ( c = getopt( argc, argv, "f:o:rd:m:k:j:H:h" ) ) != -1 )
+		switch( c )
+		{
+			case 'h':
+				printf( "[-f positions_file (stdin)] [-o output_file (stdout)] [-r (binary records)] [-d depth (8)] [-m ms_per_position] [-k best moves (3)] [-j threads (cores)] [-H hash_MB per thread (%d)]\n", ANALYSE_DEFAULT_MB );
+				return 0;
+			case 'f':
+				fileName = optarg;
+				break;
+			case 'o':
+				outName = optarg;
+				break;
+			case 'r':
+				records = TRUE;
+				break;
+			case 'd':
+				depth = atoi( optarg );
+				break;
+			case 'm':
+				timeLimitMs = atoi( optarg );
+				break;
+			case 'k':
+				lineCount = atoi( optarg );
+				break;
+			case 'j':
+				threads = atoi( optarg );
+				break;
+			case 'H':
+				hashSizeMB = atoi( optarg );
+				break;
+			case '?':
+				if( optopt == 'f' || optopt == 'o' || optopt == 'd' || optopt == 'm' || optopt == 'k' || optopt == 'j' || optopt == 'H' )
+					printf( "Option -%c requires an argument.\n", ( char ) optopt );
+				else if( isprint( optopt ) )
+					printf( "Unknown option -%c\n", ( char ) optopt );
+				else
+					printf( "Unknown option character -%c\n", ( char ) optopt );
+				return 1;
+			default:
+			return 1;
+		}
+
+	//with a time limit the search goes as deep as it can, else to 8 plies
+	if( depth == 0 )
+		depth = timeLimitMs > 0 ? MAX_SEARCH_DEPTH : 8;
+	threads = threads < 1 ? 1 : ( threads > MAX_THREADS ? MAX_THREADS : threads );
+
+	if( depth < 1 || depth > MAX_SEARCH_DEPTH || timeLimitMs < 0 || lineCount < 1 || lineCount > MAX_ANALYSIS_LINES || hashSizeMB < 1 )
+	{
+		printf( "The depth must be between 1 and %d and the best moves between 1 and %d\n", MAX_SEARCH_DEPTH, MAX_ANALYSIS_LINES );
+		return 1;
+	}
+
+	if( fileName != NULL && strcmp( fileName, "-" ) != 0 )
+	{
+		if( ( in = fopen( fileName, records ? "rb" : "r" ) ) == NULL )
+		{
+			printf( "Could not open %s\n", fileName );
+			return 1;
+		}
+		inputName = fileName;
+	}
+
+	out = stdout;
+	if( outName != NULL && ( out = fopen( outName, "w" ) ) == NULL )
+	{
+		printf( "Could not open %s\n", outName );
+		return 1;
+	}
+
+	ringSize = threads * JOBS_PER_THREAD;
+	if( ( jobs = ( Job * ) calloc( ringSize, sizeof( Job ) ) ) == NULL )
+	{
+		printf( "Could not allocate the jobs\n" );
+		return 1;
+	}
+
+	//if an engine or a thread cannot be made we go on with the ones we have
+	while( started < threads && ( engines[ started ] = hexEngineCreate( hashSizeMB ) ) != NULL )
+	{
+		if( pthread_create( &workers[ started ], NULL, analyseJobs, engines[ started ] ) != 0 )
+		{
+			hexEngineDestroy( engines[ started ] );
+			break;
+		}
+		started++;
+	}
+	if( started == 0 || pthread_create( &writer, NULL, writeJobs, NULL ) != 0 )
+	{
+		printf( "Could not start the threads\n" );
+		return 1;
+	}
+
+	seconds = getTimeSeconds();
+	readJobs( in, records );
+
+	for( i = 0; i < started; i++ )
+	{
+		pthread_join( workers[ i ], NULL );
+		hexEngineDestroy( engines[ i ] );
+	}
+	pthread_join( writer, NULL );
+	seconds = getTimeSeconds() - seconds;
+
+	if( ferror( in ) )
+		errors++;
+
+	fprintf( out, "# %lld positions %llu nodes %.3f s %.1f positions/s %.0f nps, %d threads\n", positions, total.nodes, seconds,
+			seconds > 0 ? positions / seconds : 0, seconds > 0 ? total.nodes / seconds : 0, started );
+
+	if( out != stdout && fclose( out ) != 0 )
+		errors++;
+	if( in != stdin )
+		fclose( in );
+	free( jobs );
+
+	return errors ? 1 : 0;
+}
@@ -0,0 +1,183 @@
+#include "analysis.h"
+#include <string.h>
+
+
+/**
+ * Completes line->pv from the position of info (the root move is played) with the best moves the table keeps,
+ * as long as they come from exact entries, are legal and the depth of the analysis is not reached
+ */
+static void readPrincipalVariation(SearchInfo *info, AnalysisLine *line, int depth)
+{
+    Position *pos = &info->pos;
+    int played = 0;
+
+    line->pvLength = 1;
+    while (line->pvLength < depth) {
+        MoveList list;
+        Move move;
+        generateMoves(pos, pos->turn, &list);
+
+        if (list.count == 0) {
+            // the game is over, else the pass is part of the line
+            if (!canMove(pos, getOtherSide(pos->turn))) {
+                break;
+            }
+            move.tile[0] = NULL_MOVE;
+            move.color   = pos->turn;
+            makeMove(pos, &move, &info->undo);
+        } else {
+            TTData entry;
+            if (!ttProbe(info->tt, pos->hash, &entry) || entry.bound != TT_EXACT || entry.bestMove.tile[0] == NULL_MOVE) {
+                break;
+            }
+            entry.bestMove.color = pos->turn;
+            GeneratedMove *found = findGeneratedMove(&list, &entry.bestMove);
+            if (found == NULL) {
+                break;
+            }
+            move = found->move;
+            makeGeneratedMove(pos, found, &info->undo);
+        }
+        line->pv[line->pvLength++] = move;
+        played++;
+    }
+
+    while (played-- > 0) {
+        unmakeMove(pos, &info->undo);
+    }
+}
+
+/**
+ * Puts the moves of the lines first in list, in the order of the lines, the other moves keep their order
+ */
+static void moveLinesFirst(MoveList *list, const AnalysisLine *lines, int count)
+{
+    GeneratedMove ordered[MAX_MOVES];
+    int used[MAX_MOVES];
+    int n = 0;
+
+    memset(used, 0, list->count * sizeof(int));
+    for (int i = 0; i < count; i++) {
+        for (int j = 0; j < list->count; j++) {
+            if (!used[j] && list->moves[j].move.tile[0] == lines[i].move.tile[0] && list->moves[j].move.tile[1] == lines[i].move.tile[1]) {
+                ordered[n++] = list->moves[j];
+                used[j] = TRUE;
+                break;
+            }
+        }
+    }
+    for (int j = 0; j < list->count; j++) {
+        if (!used[j]) {
+            ordered[n++] = list->moves[j];
+        }
+    }
+    memcpy(list->moves, ordered, n * sizeof(GeneratedMove));
+}
+
+/**
+ * Iterative deepening over the root moves. Each iteration keeps the lineCount best moves with their exact values,
+ * best first. Until the list is full every move is searched with the full window. Then alpha is raised to the
+ * value of the last line: a move that cannot beat it fails low at the cost of a null window search, and a move
+ * that does comes back with its exact value (beta stays at infinity) and takes the place of the last line.
+ * So the lineCount lines cost little more than one search, not lineCount of them.
+ * With a time limit the lines of the last iteration that finished are kept, an iteration cut by the clock is dropped
+ */
+int analysePosition(const Position *rootPos, int depth, int timeLimitMs, int lineCount, TranspositionTable *tt, AnalysisLine *lines, SearchReport *report)
+{
+    double start = getTimeSeconds();
+    SearchInfo info;
+
+    memcpy(&info.pos, rootPos, sizeof(Position));
+    initUndoStack(&info.undo);
+    memset(&info.stats, 0, sizeof(SearchStats));
+    info.deadline = 0;
+    info.aborted = FALSE;
+    info.reachedDepthLimit = FALSE;
+    info.tt = tt;
+    info.stop = NULL;
+
+    initPhaseTiming();
+    if (report != NULL) {
+        memset(report, 0, sizeof(SearchReport));
+    }
+
+    MoveList list;
+    generateMoves(&info.pos, info.pos.turn, &list);
+    orderMovesByFlips(&list);
+
+    // the principal variations hold MAX_SEARCH_DEPTH moves, without an iteration there are no lines
+    depth = depth < MAX_SEARCH_DEPTH ? depth : MAX_SEARCH_DEPTH;
+    lineCount = lineCount < MAX_ANALYSIS_LINES ? lineCount : MAX_ANALYSIS_LINES;
+    lineCount = lineCount < list.count ? lineCount : list.count;
+    if (lineCount <= 0 || depth < 1) {
+        return 0;
+    }
+    if (tt != NULL) {
+        ttNewSearch(tt);
+    }
+
+    AnalysisLine current[MAX_ANALYSIS_LINES];
+    int completed = 0;
+    for (int d = 1; d <= depth; d++) {
+        int found = 0;
+
+        // the first iteration always finishes, so there are lines whatever the time limit
+        info.deadline = d > 1 && timeLimitMs > 0 ? start + timeLimitMs / 1000.0 : 0;
+        info.reachedDepthLimit = FALSE;
+
+        for (int i = 0; i < list.count; i++) {
+            int floor = found < lineCount ? -SEARCH_INFINITY : current[lineCount-1].score;
+
+            makeGeneratedMove(&info.pos, &list.moves[i], &info.undo);
+            int value = -principalVariationSearch(&info, d-1, -SEARCH_INFINITY, -floor);
+
+            if (info.aborted) {
+                unmakeMove(&info.pos, &info.undo);
+                break;
+            }
+            if (value > floor) {
+                AnalysisLine line;
+                line.move = list.moves[i].move;
+                line.score = value;
+                line.pv[0] = line.move;
+                line.pvLength = 1;
+                // the table is read right away, the searches of the next moves may replace the entries of this line
+                if (tt != NULL) {
+                    readPrincipalVariation(&info, &line, d);
+                }
+
+                // insertion in the lines, the last one drops out when they are full, ties keep the earlier move
+                int j = found < lineCount ? found++ : lineCount - 1;
+                while (j > 0 && current[j-1].score < value) {
+                    current[j] = current[j-1];
+                    j--;
+                }
+                current[j] = line;
+            }
+            unmakeMove(&info.pos, &info.undo);
+        }
+        if (info.aborted) {
+            break;
+        }
+        memcpy(lines, current, found * sizeof(AnalysisLine));
+        completed = d;
+
+        // every line reached the end of the game, deeper iterations would find the same
+        if (!info.reachedDepthLimit) {
+            break;
+        }
+        if (info.deadline > 0 && getTimeSeconds() - start > timeLimitMs / 2000.0) {
+            break;
+        }
+        // the next iteration starts with the best lines, so alpha is raised as early as possible
+        moveLinesFirst(&list, lines, found);
+    }
+
+    if (report != NULL) {
+        report->depth = completed;
+        report->score = lines[0].score;
+        report->stats = info.stats;
+        report->seconds = getTimeSeconds() - start;
+    }
+    return lineCount;
+}
@@ -0,0 +1,31 @@
+#ifndef _ANALYSIS_H
+#define _ANALYSIS_H
+
+#include "search.h"
+
+/**********************************************************/
+
+/* Most root moves analysePosition() scores exactly, the others only have to fail low */
+#define MAX_ANALYSIS_LINES 32
+
+/**
+ *  One of the best root moves: its exact value at the depth of the analysis and the line the search expects
+ *  after it, read back from the transposition table (it ends early where the table lost an entry)
+ */
+typedef struct {
+    Move move;
+    int score;                     // for the player to move at the root
+    Move pv[MAX_SEARCH_DEPTH];     // pv[0] is move, a NULL move is a pass
+    int pvLength;
+} AnalysisLine;
+
+/**********************************************************/
+
+int analysePosition(const Position *rootPos, int depth, int timeLimitMs, int lineCount, TranspositionTable *tt, AnalysisLine *lines, SearchReport *report);
+// the lineCount best moves of rootPos (at most MAX_ANALYSIS_LINES) searched to depth plies with PVS, best first,
+// or as deep as timeLimitMs allows (0 for no limit). tt is needed for the principal variations. Returns how many
+// lines were found: fewer if there are fewer moves, 0 if the player to move has to pass, the game is over or depth
+// is below 1. A depth above MAX_SEARCH_DEPTH searches MAX_SEARCH_DEPTH plies.
+// report can be NULL, its depth is the deepest iteration that finished
+
+#endif
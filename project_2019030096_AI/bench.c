@@ -0,0 +1,220 @@
+#include "global.h"
+#include "board.h"
+#include "move.h"
+#include "search.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <unistd.h>
+
+
+/* Benchmark: runs the search algorithms of the client on a fixed set of positions to a fixed depth
+ * and prints the nodes, the time and the nodes per second of each algorithm and of all of them.
+ *
+ * Every search runs in one thread, without a time limit, the endgame solver or a book, and starts
+ * with an empty transposition table, so its nodes and its move only depend on the search and board
+ * code. They are all folded into one signature: a change that keeps the signature did not change
+ * what the searches do, and the times tell if it made them faster. */
+
+#define MAX_LINE 1024
+
+static const char * benchNames[ NUM_ALGORITHMS ] = { "minimax", "alphabeta", "ordering", "negamax", "ybwc", "pvs" };
+
+static TranspositionTable tt;
+
+/* totals of each algorithm */
+static unsigned long long totalNodes[ NUM_ALGORITHMS ];
+static double totalSeconds[ NUM_ALGORITHMS ];
+static int searches[ NUM_ALGORITHMS ];
+
+/* FNV-1a over the nodes and the moves of every search */
+static uint64_t signature = 0xcbf29ce484222325ULL;
+
+
+/**********************************************************/
+static void addToSignature( uint64_t value )
+{
+	int i;
+
+	for( i = 0; i < 8; i++ )
+	{
+		signature ^= ( value >> ( 8 * i ) ) & 0xff;
+		signature *= 0x100000001b3ULL;
+	}
+}
+
+/**********************************************************/
+/* Searches pos with alg to depth plies, adds it to the totals and the signature */
+static void benchSearch( const char * name, Position * pos, int alg, int depth, int verbose )
+{
+	SearchOptions options = { depth, 0, 1, &tt, NULL, 0 };
+	SearchReport report;
+	Move move;
+	double seconds;
+
+	ttClear( &tt );
+
+	seconds = getTimeSeconds();
+	move = findBestMove( pos, pos->turn, alg, &options, &report );
+	seconds = getTimeSeconds() - seconds;
+
+	totalNodes[ alg ] += report.stats.nodes;
+	totalSeconds[ alg ] += seconds;
+	searches[ alg ]++;
+
+	addToSignature( alg );
+	addToSignature( report.stats.nodes );
+	addToSignature( move.tile[ 0 ] == NULL_MOVE ? NULL_MOVE : getCell( move.tile[ 0 ], move.tile[ 1 ] ) );
+
+	if( verbose )
+	{
+		printf( "%-10s %-10s depth %2d %12llu nodes %8.3f s %12.0f nps", name, benchNames[ alg ], depth, report.stats.nodes, seconds, seconds > 0 ? report.stats.nodes / seconds : 0 );
+		if( move.tile[ 0 ] == NULL_MOVE )
+			printf( "   pass\n" );
+		else
+			printf( "   %d,%d\n", move.tile[ 0 ], move.tile[ 1 ] );
+		fflush( stdout );
+	}
+}
+
+/**********************************************************/
+/* Each line of the file is a position in text form (see positionFromText()) and the depth of each algorithm,
+ * -a 0 first (the tree searches keep the whole tree in memory, so they cannot go as deep as the others).
+ * Empty lines and lines starting with # are skipped. Returns the number of lines that could not be read */
+static int benchFile( const char * fileName, int onlyAlg, int depthGiven, int verbose )
+{
+	FILE * file;
+	char line[ MAX_LINE ];
+	char name[ 32 ];
+	Position pos;
+	int depths[ NUM_ALGORITHMS ];
+	int used, alg, valid, lineNumber = 0, errors = 0;
+	char * text;
+
+	if( ( file = fopen( fileName, "r" ) ) == NULL )
+	{
+		printf( "Could not open %s\n", fileName );
+		return 1;
+	}
+
+	while( fgets( line, MAX_LINE, file ) != NULL )
+	{
+		lineNumber++;
+
+		if( line[ 0 ] == '#' || line[ strspn( line, " \t\r\n" ) ] == '\0' )
+			continue;
+
+		valid = ( used = positionFromText( &pos, line ) ) > 0;
+		for( alg = 0, text = line + used; valid && alg < NUM_ALGORITHMS; alg++ )
+		{
+			depths[ alg ] = strtol( text, &text, 10 );
+			valid = depths[ alg ] >= 1 && depths[ alg ] <= MAX_SEARCH_DEPTH;
+		}
+		if( !valid )
+		{
+			printf( "%s:%d: not a position and %d depths\n", fileName, lineNumber, NUM_ALGORITHMS );
+			errors++;
+			continue;
+		}
+
+		snprintf( name, sizeof( name ), "line %d", lineNumber );
+
+		for( alg = 0; alg < NUM_ALGORITHMS; alg++ )
+		{
+			if( onlyAlg >= 0 && alg != onlyAlg )
+				continue;
+
+			if( depthGiven > 0 )
+				benchSearch( name, &pos, alg, depthGiven, verbose );
+			else
+				benchSearch( name, &pos, alg, depths[ alg ], verbose );
+		}
+	}
+
+	fclose( file );
+	return errors;
+}
+
+/**********************************************************/
+int main( int argc, char **argv )
+{
+	int c;
+	int onlyAlg = -1;
+	int depthGiven = 0;
+	int verbose = FALSE;
+	char * fileName = "bench.txt";
+	char * expected = NULL;
+	unsigned long long nodes = 0;
+	double seconds = 0;
+	int alg, errors;
+
+	opterr = 0;
+
+	while( ( c = getopt( argc, argv, "f:a:d:s:vh" ) ) != -1 )
+		switch( c )
+		{
+			case 'h':
+				printf( "[-f positions_file (bench.txt)] [-a algorithm (all)] [-d depth (of the file)] [-s expected_signature] [-v (every search)]\n" );
+				return 0;
+			case 'f':
+				fileName = optarg;
+				break;
+			case 'a':
+				onlyAlg = atoi( optarg );
+				break;
+			case 'd':
+				depthGiven = atoi( optarg );
+				break;
+			case 's':
+				expected = optarg;
+				break;
+			case 'v':
+				verbose = TRUE;
+				break;
+			case '?':
+				if( optopt == 'f' || optopt == 'a' || optopt == 'd' || optopt == 's' )
+					printf( "Option -%c requires an argument.\n", ( char ) optopt );
+				else if( isprint( optopt ) )
+					printf( "Unknown option -%c\n", ( char ) optopt );
+				else
+					printf( "Unknown option character -%c\n", ( char ) optopt );
+				return 1;
+			default:
+			return 1;
+		}
+
+	if( onlyAlg >= NUM_ALGORITHMS || depthGiven < 0 || depthGiven > MAX_SEARCH_DEPTH )
+	{
+		printf( "The algorithm must be between 0 and %d and the depth between 1 and %d\n", NUM_ALGORITHMS - 1, MAX_SEARCH_DEPTH );
+		return 1;
+	}
+
+	if( !ttInit( &tt, TT_DEFAULT_MB ) )
+	{
+		printf( "Could not allocate the transposition table\n" );
+		return 1;
+	}
+
+	errors = benchFile( fileName, onlyAlg, depthGiven, verbose );
+	ttFree( &tt );
+
+	for( alg = 0; alg < NUM_ALGORITHMS; alg++ )
+	{
+		if( searches[ alg ] == 0 )
+			continue;
+		printf( "%-10s %3d searches %12llu nodes %8.3f s %12.0f nps\n", benchNames[ alg ], searches[ alg ], totalNodes[ alg ], totalSeconds[ alg ], totalSeconds[ alg ] > 0 ? totalNodes[ alg ] / totalSeconds[ alg ] : 0 );
+		nodes += totalNodes[ alg ];
+		seconds += totalSeconds[ alg ];
+	}
+	printf( "%-10s              %12llu nodes %8.3f s %12.0f nps\n", "total", nodes, seconds, seconds > 0 ? nodes / seconds : 0 );
+	printf( "signature %016llx\n", ( unsigned long long ) signature );
+
+	if( expected != NULL && strtoull( expected, NULL, 16 ) != signature )
+	{
+		printf( "SIGNATURE MISMATCH, expected %s\n", expected );
+		errors++;
+	}
+
+	return errors ? 1 : 0;
+}
@@ -0,0 +1,157 @@
+#ifndef _BITBOARD_H
+#define _BITBOARD_H
+
+#include "global.h"
+#include <stdint.h>
+
+/**********************************************************/
+
+/* One bit per square of the array board. Square (row, col) is bit row * ARRAY_BOARD_SIZE + col,
+ * the same offset it has in the network buffer. Only the 169 hex cells are ever set. */
+#define BB_SQUARES ( ARRAY_BOARD_SIZE * ARRAY_BOARD_SIZE )
+#define BB_WORDS ( ( BB_SQUARES + 63 ) / 64 )
+
+#define SQUARE( row, col ) ( ( row ) * ARRAY_BOARD_SIZE + ( col ) )
+#define SQUARE_ROW( sq ) ( ( sq ) / ARRAY_BOARD_SIZE )
+#define SQUARE_COL( sq ) ( ( sq ) % ARRAY_BOARD_SIZE )
+
+typedef struct
+{
+	uint64_t w[ BB_WORDS ];
+} BitBoard;
+
+/**********************************************************/
+static inline BitBoard bbZero( void )
+{
+	BitBoard r;
+	int i;
+
+	for( i = 0; i < BB_WORDS; i++ )
+		r.w[ i ] = 0;
+	return r;
+}
+
+static inline BitBoard bbAnd( BitBoard a, BitBoard b )
+{
+	int i;
+
+	for( i = 0; i < BB_WORDS; i++ )
+		a.w[ i ] &= b.w[ i ];
+	return a;
+}
+
+static inline BitBoard bbOr( BitBoard a, BitBoard b )
+{
+	int i;
+
+	for( i = 0; i < BB_WORDS; i++ )
+		a.w[ i ] |= b.w[ i ];
+	return a;
+}
+
+static inline BitBoard bbXor( BitBoard a, BitBoard b )
+{
+	int i;
+
+	for( i = 0; i < BB_WORDS; i++ )
+		a.w[ i ] ^= b.w[ i ];
+	return a;
+}
+
+static inline BitBoard bbAndNot( BitBoard a, BitBoard b )		//a & ~b
+{
+	int i;
+
+	for( i = 0; i < BB_WORDS; i++ )
+		a.w[ i ] &= ~b.w[ i ];
+	return a;
+}
+
+static inline int bbIsEmpty( BitBoard b )
+{
+	int i;
+	uint64_t any = 0;
+
+	for( i = 0; i < BB_WORDS; i++ )
+		any |= b.w[ i ];
+	return any == 0;
+}
+
+static inline int bbCount( BitBoard b )
+{
+	int i, n = 0;
+
+	for( i = 0; i < BB_WORDS; i++ )
+		n += __builtin_popcountll( b.w[ i ] );
+	return n;
+}
+
+static inline int bbTest( BitBoard b, int sq )
+{
+	return ( b.w[ sq >> 6 ] >> ( sq & 63 ) ) & 1;
+}
+
+static inline void bbSet( BitBoard * b, int sq )
+{
+	b->w[ sq >> 6 ] |= 1ULL << ( sq & 63 );
+}
+
+static inline void bbClear( BitBoard * b, int sq )
+{
+	b->w[ sq >> 6 ] &= ~( 1ULL << ( sq & 63 ) );
+}
+
+static inline BitBoard bbSquare( int sq )
+{
+	BitBoard r = bbZero();
+
+	bbSet( &r, sq );
+	return r;
+}
+
+/* Removes the lowest set square from b and returns it (b must not be empty) */
+static inline int bbPopLowest( BitBoard * b )
+{
+	int i, sq;
+
+	for( i = 0; i < BB_WORDS - 1 && !b->w[ i ]; i++ )
+		;
+	sq = __builtin_ctzll( b->w[ i ] );
+	b->w[ i ] &= b->w[ i ] - 1;
+	return ( i << 6 ) + sq;
+}
+
+/* Shifts every square by s bit positions (s > 0 towards higher squares, s < 0 towards lower).
+ * Bits leaving the board are lost; callers mask the result against the hex cells. */
+static inline BitBoard bbShift( BitBoard b, int s )
+{
+	BitBoard r;
+	int i, words, bits;
+
+	if( s >= 0 )
+	{
+		words = s >> 6;
+		bits = s & 63;
+		for( i = BB_WORDS - 1; i >= 0; i-- )
+		{
+			uint64_t hi = ( i - words >= 0 ) ? b.w[ i - words ] : 0;
+			uint64_t lo = ( i - words - 1 >= 0 ) ? b.w[ i - words - 1 ] : 0;
+			r.w[ i ] = bits ? ( hi << bits ) | ( lo >> ( 64 - bits ) ) : hi;
+		}
+	}
+	else
+	{
+		words = ( -s ) >> 6;
+		bits = ( -s ) & 63;
+		for( i = 0; i < BB_WORDS; i++ )
+		{
+			uint64_t lo = ( i + words < BB_WORDS ) ? b.w[ i + words ] : 0;
+			uint64_t hi = ( i + words + 1 < BB_WORDS ) ? b.w[ i + words + 1 ] : 0;
+			r.w[ i ] = bits ? ( lo >> bits ) | ( hi << ( 64 - bits ) ) : lo;
+		}
+	}
+	return r;
+}
+
+
+#endif
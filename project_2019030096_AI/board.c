@@ -2,8 +2,149 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
+#include <pthread.h>
 
 
+/* Bit shift that moves a square one step in each direction */
+static const int dirShift[ NUM_DIRECTIONS ] =
+{
+	-ARRAY_BOARD_SIZE, -ARRAY_BOARD_SIZE + 1, -1, 1, ARRAY_BOARD_SIZE - 1, ARRAY_BOARD_SIZE
+};
+static const signed char dirRow[ NUM_DIRECTIONS ] = { -1, -1, 0, 0, 1, 1 };
+static const signed char dirCol[ NUM_DIRECTIONS ] = { 0, 1, -1, 1, -1, 0 };
+
+/* shiftMask[ d ] holds the hex cells whose neighbour in direction -d is also a hex cell.
+ * ANDing a shifted bitboard with it drops every bit that wrapped around a row or left the hexagon. */
+static BitBoard hexCells;
+static BitBoard shiftMask[ NUM_DIRECTIONS ];
+
+/* Dense layout of the board array: the hex cells numbered row by row, without the OUT_OF_BOUND padding.
+ * cellSquare / squareCell translate between a cell and its bit in the bitboards */
+static short cellIndex[ ARRAY_BOARD_SIZE ][ ARRAY_BOARD_SIZE ];
+static unsigned char cellRow[ BOARD_CELLS ];
+static unsigned char cellCol[ BOARD_CELLS ];
+static unsigned char cellSquare[ BOARD_CELLS ];
+static short squareCell[ BB_SQUARES ];
+static short neighbour[ BOARD_CELLS ][ NUM_DIRECTIONS ];
+
+/* Zobrist keys: one per color and square, one for BLACK to move. zobristFlip[ sq ] turns a piece over */
+static uint64_t zobristPiece[ 2 ][ BB_SQUARES ];
+static uint64_t zobristFlip[ BB_SQUARES ];
+static uint64_t zobristBlackTurn;
+
+/* rayCells[ c ][ d ] lists the cells met when walking from cell c in direction d, nearest first,
+ * up to the edge of the hexagon. rayLength[ c ][ d ] is how many there are */
+static unsigned char rayCells[ BOARD_CELLS ][ NUM_DIRECTIONS ][ ARRAY_BOARD_SIZE - 1 ];
+static unsigned char rayLength[ BOARD_CELLS ][ NUM_DIRECTIONS ];
+
+/* filled once, by the first thread that needs them */
+static pthread_once_t tablesOnce = PTHREAD_ONCE_INIT;
+
+
+/**********************************************************/
+static int isHexCell( int row, int col )
+{
+	if( row < 0 || row >= ARRAY_BOARD_SIZE || col < 0 || col >= ARRAY_BOARD_SIZE )
+		return FALSE;
+	return row + col >= HEX_BOARD_RADIUS && row + col <= 3 * HEX_BOARD_RADIUS;
+}
+
+/**********************************************************/
+/* splitmix64, fixed seed so that keys (and anything stored by key) are the same in every run */
+static uint64_t nextZobristKey( uint64_t * state )
+{
+	uint64_t z = ( *state += 0x9E3779B97F4A7C15ULL );
+
+	z = ( z ^ ( z >> 30 ) ) * 0xBF58476D1CE4E5B9ULL;
+	z = ( z ^ ( z >> 27 ) ) * 0x94D049BB133111EBULL;
+	return z ^ ( z >> 31 );
+}
+
+/**********************************************************/
+static void initBoardTables( void )
+{
+	int row, col, d, sq, cell = 0;
+	uint64_t seed = 0x48657874686C6CULL;
+
+	hexCells = bbZero();
+	for( d = 0; d < NUM_DIRECTIONS; d++ )
+		shiftMask[ d ] = bbZero();
+	for( sq = 0; sq < BB_SQUARES; sq++ )
+		squareCell[ sq ] = -1;
+
+	for( row = 0; row < ARRAY_BOARD_SIZE; row++ )
+		for( col = 0; col < ARRAY_BOARD_SIZE; col++ )
+		{
+			cellIndex[ row ][ col ] = -1;
+			if( !isHexCell( row, col ) )
+				continue;
+
+			cellIndex[ row ][ col ] = cell;
+			cellRow[ cell ] = row;
+			cellCol[ cell ] = col;
+			cellSquare[ cell ] = SQUARE( row, col );
+			squareCell[ SQUARE( row, col ) ] = cell;
+			cell++;
+
+			bbSet( &hexCells, SQUARE( row, col ) );
+			for( d = 0; d < NUM_DIRECTIONS; d++ )
+				if( isHexCell( row - dirRow[ d ], col - dirCol[ d ] ) )
+					bbSet( &shiftMask[ d ], SQUARE( row, col ) );
+		}
+
+	for( cell = 0; cell < BOARD_CELLS; cell++ )
+		for( d = 0; d < NUM_DIRECTIONS; d++ )
+		{
+			row = cellRow[ cell ] + dirRow[ d ];
+			col = cellCol[ cell ] + dirCol[ d ];
+			neighbour[ cell ][ d ] = isHexCell( row, col ) ? cellIndex[ row ][ col ] : -1;
+		}
+
+	/* rays are followed through the neighbour table */
+	for( cell = 0; cell < BOARD_CELLS; cell++ )
+		for( d = 0; d < NUM_DIRECTIONS; d++ )
+		{
+			int next = neighbour[ cell ][ d ], n = 0;
+
+			for( ; next >= 0; next = neighbour[ next ][ d ] )
+				rayCells[ cell ][ d ][ n++ ] = next;
+			rayLength[ cell ][ d ] = n;
+		}
+
+	for( sq = 0; sq < BB_SQUARES; sq++ )
+	{
+		zobristPiece[ WHITE ][ sq ] = nextZobristKey( &seed );
+		zobristPiece[ BLACK ][ sq ] = nextZobristKey( &seed );
+		zobristFlip[ sq ] = zobristPiece[ WHITE ][ sq ] ^ zobristPiece[ BLACK ][ sq ];
+	}
+	zobristBlackTurn = nextZobristKey( &seed );
+}
+
+/**********************************************************/
+/* Occluded fill: gen plus every square reached by stepping from gen in direction d over pro */
+static inline BitBoard fillDirection( BitBoard gen, BitBoard pro, int d )
+{
+	int s = dirShift[ d ];
+
+	pro = bbAnd( pro, shiftMask[ d ] );
+	gen = bbOr( gen, bbAnd( pro, bbShift( gen, s ) ) );
+	pro = bbAnd( pro, bbShift( pro, s ) );
+	gen = bbOr( gen, bbAnd( pro, bbShift( gen, 2 * s ) ) );
+	pro = bbAnd( pro, bbShift( pro, 2 * s ) );
+	gen = bbOr( gen, bbAnd( pro, bbShift( gen, 4 * s ) ) );
+	pro = bbAnd( pro, bbShift( pro, 4 * s ) );
+	gen = bbOr( gen, bbAnd( pro, bbShift( gen, 8 * s ) ) );
+
+	return gen;
+}
+
+/**********************************************************/
+/* One step in direction d, without wrapping */
+static inline BitBoard stepDirection( BitBoard b, int d )
+{
+	return bbAnd( bbShift( b, dirShift[ d ] ), shiftMask[ d ] );
+}
+
 
 /**********************************************************/
 void initPosition( Position * pos )		//to add illegal tiles change ONLY this function! ...everything else will work...hopefully
@@ -11,18 +152,20 @@ void initPosition( Position * pos )		//to add illegal tiles change ONLY this fun
 	int i, j;
 	int illegalPerRow = HEX_BOARD_RADIUS;
 
+	pthread_once( &tablesOnce, initBoardTables );
+
 	for( i = 0; i < ARRAY_BOARD_SIZE; i++ )
 	{
 		for( j = 0; j < ARRAY_BOARD_SIZE; j++ )
 		{
 			if( illegalPerRow > j || (illegalPerRow < 0 && (j >= illegalPerRow + ARRAY_BOARD_SIZE)) )
-				pos->board[ i ][ j ] = OUT_OF_BOUND;
+				continue;		//OUT_OF_BOUND, not stored in the array
 			else if( (j == HEX_BOARD_RADIUS && (i == HEX_BOARD_RADIUS || i == HEX_BOARD_RADIUS - 1)) || (i == HEX_BOARD_RADIUS && j == HEX_BOARD_RADIUS + 1 ) || ( i == HEX_BOARD_RADIUS + 1 && j == HEX_BOARD_RADIUS - 1 ) )
-					pos->board[ i ][ j ] = WHITE;
+					pos->board[ cellIndex[ i ][ j ] ] = WHITE;
 			else if( (i == HEX_BOARD_RADIUS && j == HEX_BOARD_RADIUS - 1 ) || (i == HEX_BOARD_RADIUS - 1 && j == HEX_BOARD_RADIUS + 1) || (i == HEX_BOARD_RADIUS + 1 && j == HEX_BOARD_RADIUS ) )
-					pos->board[ i ][ j ] = BLACK;
+					pos->board[ cellIndex[ i ][ j ] ] = BLACK;
 			else
-				pos->board[ i ][ j ] = EMPTY;
+				pos->board[ cellIndex[ i ][ j ] ] = EMPTY;
 		}
 		illegalPerRow--;
 	}
@@ -35,16 +178,19 @@ void initPosition( Position * pos )		//to add illegal tiles change ONLY this fun
 	/* Black plays first */
 	pos->turn = BLACK;
 
+	updateBitBoards( pos );
+
 }
 
 
 /**********************************************************/
-void printBoard( char board[ ARRAY_BOARD_SIZE ][ ARRAY_BOARD_SIZE ] )
+void printBoard( char board[ BOARD_CELLS ] )
 {
-	int i, j;
+	int i, cell = 0;
 	int spacePerRow = HEX_BOARD_RADIUS;
 	int spaceCounter;
 
+	pthread_once( &tablesOnce, initBoardTables );
 
 	/* Print board */
 	for( i = 0; i < ARRAY_BOARD_SIZE; i++ )
@@ -53,11 +199,10 @@ void printBoard( char board[ ARRAY_BOARD_SIZE ][ ARRAY_BOARD_SIZE ] )
 		for( spaceCounter = 0; spaceCounter < abs(spacePerRow); spaceCounter++ )
 			printf(" ");
 
-		for( j = 0; j < ARRAY_BOARD_SIZE; j++ )
-			switch( board[ i ][ j ] )
+		/* cells are stored row by row, so the cells of row i follow each other */
+		for( ; cell < BOARD_CELLS && cellRow[ cell ] == i; cell++ )
+			switch( board[ cell ] )
 			{
-				case OUT_OF_BOUND:
-					break;
 				case WHITE:
 					printf( "W " );
 					break;
@@ -103,62 +248,66 @@ void printPosition( Position * pos )
 }
 
 /**********************************************************/
-int doOneDirection( Position * pos, Move * moveToPlay, int do_move, signed char inc_row, signed char inc_col )
+/* Mailbox walk along the precomputed ray of direction d, no bounds checks needed */
+static int doOneRay( Position * pos, Move * moveToPlay, int do_move, int d )
 {
-	unsigned short int i,j;
-	unsigned short int opponent;
-
-	opponent = getOtherSide( moveToPlay->color );
-
-	/* Quick rejects - are we too close to the borders? */
-	if((inc_row == -1 && moveToPlay->tile[ 0 ] < 2) || (inc_row == 1  && moveToPlay->tile[ 0 ] >= ARRAY_BOARD_SIZE-2))
-		return FALSE;
-	if((inc_col == -1 && moveToPlay->tile[ 1 ] < 2) || (inc_col == 1  && moveToPlay->tile[ 1 ] >= ARRAY_BOARD_SIZE-2))
-		return FALSE;
-
-	i = moveToPlay->tile[ 0 ] + inc_row; 
-	j = moveToPlay->tile[ 1 ] + inc_col;
-
-	/* The adjacent square must be in the opposite color. */
-	if( pos->board[ i ][ j ] != opponent )
+	int cell = cellIndex[ moveToPlay->tile[ 0 ] ][ moveToPlay->tile[ 1 ] ];
+	const unsigned char * ray;
+	int length;
+	char * cells = pos->board;
+	char color = moveToPlay->color;
+	char opponent = getOtherSide( color );
+	int n, k;
+
+	if( cell < 0 )
 		return FALSE;
+	ray = rayCells[ cell ][ d ];
+	length = rayLength[ cell ][ d ];
 
 	/* Go over all the consecutive squares in the opponents color */
-	do
-	{
-		i += inc_row; 
-		j += inc_col;
-		if( i<0 || i>=ARRAY_BOARD_SIZE || j<0 || j>=ARRAY_BOARD_SIZE)
-			break;
-		if(pos->board[ i ][ j ] !=opponent)
-			break;
-	}
-	while(1);
+	for( n = 0; n < length && cells[ ray[ n ] ] == opponent; n++ )
+		;
 
-	/* Have we reached the end of the board or not a piece of ours (failure)? */
-	if(i < 0 || i >= ARRAY_BOARD_SIZE || j < 0 || j >= ARRAY_BOARD_SIZE || pos->board[ i ][ j ]!=moveToPlay->color)
+	/* We need at least one of them, followed by a piece of ours */
+	if( n == 0 || n == length || cells[ ray[ n ] ] != color )
 		return FALSE;
 
 	/* If we have reached here, then we have a legal move !!! */
-	if (!do_move)
+	if( !do_move )
 		return TRUE;
 
 	/* Flip the other side pieces */
-	for (i-=inc_row, j-=inc_col; i != moveToPlay->tile[ 0 ] || j != moveToPlay->tile[ 1 ]; i-=inc_row, j-=inc_col) 
+	for( k = 0; k < n; k++ )
 	{
-		pos->board[ i ][ j ] = moveToPlay->color;
-		pos->score[ (int) moveToPlay->color ]++;
-		pos->score[ opponent ]--;
+		int sq = cellSquare[ ray[ k ] ];
+
+		cells[ ray[ k ] ] = color;
+		bbSet( &pos->disc[ (int) color ], sq );
+		bbClear( &pos->disc[ (int) opponent ], sq );
+		pos->hash ^= zobristFlip[ sq ];
 	}
+	pos->score[ (int) color ] += n;
+	pos->score[ (int) opponent ] -= n;
 
 	return TRUE;
+}
+
+/**********************************************************/
+int doOneDirection( Position * pos, Move * moveToPlay, int do_move, signed char inc_row, signed char inc_col )
+{
+	int d;
 
+	for( d = 0; d < NUM_DIRECTIONS; d++ )
+		if( dirRow[ d ] == inc_row && dirCol[ d ] == inc_col )
+			return doOneRay( pos, moveToPlay, do_move, d );
+
+	return FALSE;
 }
 
 /**********************************************************/
 int doAllDirections( Position * pos, Move * moveToPlay, int do_move )
 {
-	short int i,j;
+	int d;
 	int legal = FALSE; /* Was the move found to be legal already? */
 
 
@@ -166,25 +315,29 @@ int doAllDirections( Position * pos, Move * moveToPlay, int do_move )
 	if( ( moveToPlay->tile[ 0 ] == NULL_MOVE ) && do_move)
 	{
 		pos->turn = getOtherSide( pos->turn );
+		pos->hash ^= zobristBlackTurn;
 		return TRUE;
 	}
 
-	for (i=-1 ; i <= 1 ; i++)
-		for (j=-1 ; j <= 1 ; j++)
-		{
-			if (j == i)
-				continue;
-			if(doOneDirection( pos, moveToPlay, do_move, i, j))
-				legal = TRUE;
+	if( moveToPlay->tile[ 0 ] < 0 || moveToPlay->tile[ 0 ] >= ARRAY_BOARD_SIZE || moveToPlay->tile[ 1 ] < 0 || moveToPlay->tile[ 1 ] >= ARRAY_BOARD_SIZE )
+		return FALSE;
 
-			/* If we found something legal it may be enough ... */
-			if (legal && !do_move)
-				return TRUE;
-		}
+	for( d = 0; d < NUM_DIRECTIONS; d++ )
+	{
+		if( doOneRay( pos, moveToPlay, do_move, d ) )
+			legal = TRUE;
+
+		/* If we found something legal it may be enough ... */
+		if (legal && !do_move)
+			return TRUE;
+	}
 
 	/* Put the piece in its place */
 	if(legal && do_move) {
-		pos->board[ moveToPlay->tile[ 0 ] ][ moveToPlay->tile[ 1 ] ] = moveToPlay->color;
+		pos->board[ cellIndex[ moveToPlay->tile[ 0 ] ][ moveToPlay->tile[ 1 ] ] ] = moveToPlay->color;
+		bbSet( &pos->disc[ (int) moveToPlay->color ], SQUARE( moveToPlay->tile[ 0 ], moveToPlay->tile[ 1 ] ) );
+		bbClear( &pos->empty, SQUARE( moveToPlay->tile[ 0 ], moveToPlay->tile[ 1 ] ) );
+		pos->hash ^= zobristPiece[ (int) moveToPlay->color ][ SQUARE( moveToPlay->tile[ 0 ], moveToPlay->tile[ 1 ] ) ] ^ zobristBlackTurn;
 		pos->score[ (int) moveToPlay->color ]++;
 		pos->turn = getOtherSide( pos->turn );
 	}
@@ -192,23 +345,62 @@ int doAllDirections( Position * pos, Move * moveToPlay, int do_move )
 	return legal;
 }
 
+/**********************************************************/
+static void applyFlips( Position * pos, int square, char color, BitBoard flips )
+{
+	int flipped = bbCount( flips );
+
+	/* flipped pieces change owner, the played square goes from empty to ours */
+	pos->disc[ (int) color ] = bbXor( pos->disc[ (int) color ], flips );
+	pos->disc[ getOtherSide( color ) ] = bbXor( pos->disc[ getOtherSide( color ) ], flips );
+	bbSet( &pos->disc[ (int) color ], square );
+	bbClear( &pos->empty, square );
+
+	/* keep the array and the hash in sync, only the flipped squares are touched */
+	while( !bbIsEmpty( flips ) )
+	{
+		int sq = bbPopLowest( &flips );
+		pos->board[ squareCell[ sq ] ] = color;
+		pos->hash ^= zobristFlip[ sq ];
+	}
+	pos->board[ squareCell[ square ] ] = color;
+	pos->hash ^= zobristPiece[ (int) color ][ square ] ^ zobristBlackTurn;
+
+	pos->score[ (int) color ] += flipped + 1;
+	pos->score[ getOtherSide( color ) ] -= flipped;
+	pos->turn = getOtherSide( pos->turn );
+}
+
 /**********************************************************/
 void doMove( Position * pos, Move * moveToDo )
 {
-	doAllDirections(pos, moveToDo, TRUE);
+	BitBoard flips;
+	int square;
+
+	/*null move?*/
+	if( moveToDo->tile[ 0 ] == NULL_MOVE )
+	{
+		pos->turn = getOtherSide( pos->turn );
+		pos->hash ^= zobristBlackTurn;
+		return;
+	}
+
+	square = SQUARE( moveToDo->tile[ 0 ], moveToDo->tile[ 1 ] );
+	flips = getFlips( pos, square, moveToDo->color );
+	if( bbIsEmpty( flips ) )
+		return;
+
+	applyFlips( pos, square, moveToDo->color, flips );
 }
 
 /**********************************************************/
 int isLegalMove( Position * pos, Move * moveToCheck )
 {
 
-	if(moveToCheck->tile[ 0 ] < 0 || moveToCheck->tile[ 0 ] >= ARRAY_BOARD_SIZE || moveToCheck->tile[ 1 ] < 0 || moveToCheck->tile[ 1 ] >= ARRAY_BOARD_SIZE)
+	if( getTile( pos, moveToCheck->tile[ 0 ], moveToCheck->tile[ 1 ] ) != EMPTY )
 		return FALSE;
 
-	if(pos->board[ moveToCheck->tile[ 0 ] ][ moveToCheck->tile[ 1 ] ] != EMPTY)
-		return FALSE;
-
-	return doAllDirections(pos, moveToCheck, FALSE);	//try to make the move without actually doing it
+	return !bbIsEmpty( getFlips( pos, SQUARE( moveToCheck->tile[ 0 ], moveToCheck->tile[ 1 ] ), moveToCheck->color ) );
 }
 
 /**********************************************************/
@@ -224,18 +416,430 @@ int isLegal( Position * pos, short int row, short int col, char color)
 /**********************************************************/
 int canMove( Position * pos, char color)
 {
-	unsigned short int i,j;
+	return !bbIsEmpty( getLegalMoves( pos, color ) );
+}
+
+/**********************************************************/
+int getCell( int row, int col )
+{
+	pthread_once( &tablesOnce, initBoardTables );
 
-	for(i=0 ; i <ARRAY_BOARD_SIZE ; i++)
-		for (j=0 ; j <ARRAY_BOARD_SIZE ; j++)
+	if( row < 0 || row >= ARRAY_BOARD_SIZE || col < 0 || col >= ARRAY_BOARD_SIZE )
+		return -1;
+
+	return cellIndex[ row ][ col ];
+}
+
+/**********************************************************/
+int getCellRow( int cell )
+{
+	pthread_once( &tablesOnce, initBoardTables );
+
+	return cellRow[ cell ];
+}
+
+/**********************************************************/
+int getCellCol( int cell )
+{
+	pthread_once( &tablesOnce, initBoardTables );
+
+	return cellCol[ cell ];
+}
+
+/**********************************************************/
+int getNeighbour( int cell, int direction )
+{
+	pthread_once( &tablesOnce, initBoardTables );
+
+	return neighbour[ cell ][ direction ];
+}
+
+/**********************************************************/
+char getTile( Position * pos, int row, int col )
+{
+	int cell = getCell( row, col );
+
+	if( cell < 0 )
+		return OUT_OF_BOUND;
+
+	return pos->board[ cell ];
+}
+
+/**********************************************************/
+void updateBitBoards( Position * pos )
+{
+	int cell;
+
+	pthread_once( &tablesOnce, initBoardTables );
+
+	pos->disc[ WHITE ] = bbZero();
+	pos->disc[ BLACK ] = bbZero();
+	pos->empty = bbZero();
+
+	for( cell = 0; cell < BOARD_CELLS; cell++ )
+		switch( pos->board[ cell ] )
 		{
-			if (isLegal(pos, i, j, color))
-				return TRUE;
+			case WHITE:
+			case BLACK:
+				bbSet( &pos->disc[ (int) pos->board[ cell ] ], cellSquare[ cell ] );
+				break;
+			case EMPTY:
+				bbSet( &pos->empty, cellSquare[ cell ] );
+				break;
 		}
-	return FALSE;
+
+	pos->hash = computeHash( pos );
 }
 
+/**********************************************************/
+uint64_t computeHash( Position * pos )
+{
+	uint64_t hash = 0;
+	int cell;
+
+	pthread_once( &tablesOnce, initBoardTables );
 
+	for( cell = 0; cell < BOARD_CELLS; cell++ )
+		if( pos->board[ cell ] == WHITE || pos->board[ cell ] == BLACK )
+			hash ^= zobristPiece[ (int) pos->board[ cell ] ][ cellSquare[ cell ] ];
 
+	if( pos->turn == BLACK )
+		hash ^= zobristBlackTurn;
 
+	return hash;
+}
+
+/**********************************************************/
+BitBoard getFlips( Position * pos, int square, char color )
+{
+	char other = getOtherSide( color );
+	BitBoard flips = bbZero();
+	int cell, d, k;
+
+	if( !bbTest( pos->empty, square ) )
+		return flips;
+
+	/* a single square only meets a few pieces per direction, walking its rays is cheaper than a fill */
+	cell = squareCell[ square ];
+	for( d = 0; d < NUM_DIRECTIONS; d++ )
+	{
+		const unsigned char * ray = rayCells[ cell ][ d ];
+		int length = rayLength[ cell ][ d ];
+
+		for( k = 0; k < length && pos->board[ ray[ k ] ] == other; k++ )
+			;
+
+		/* the run of opponent pieces must be closed by one of ours */
+		if( k > 0 && k < length && pos->board[ ray[ k ] ] == color )
+			while( k-- > 0 )
+				bbSet( &flips, cellSquare[ ray[ k ] ] );
+	}
+
+	return flips;
+}
 
+/**********************************************************/
+BitBoard getLegalMoves( Position * pos, char color )
+{
+	BitBoard own = pos->disc[ (int) color ];
+	BitBoard opp = pos->disc[ getOtherSide( color ) ];
+	BitBoard moves = bbZero();
+	int d;
+
+	/* Kogge-Stone fill from our pieces over opponent runs, the square right after a run is a move */
+	for( d = 0; d < NUM_DIRECTIONS; d++ )
+	{
+		BitBoard run = bbAnd( fillDirection( own, opp, d ), opp );
+		moves = bbOr( moves, stepDirection( run, d ) );
+	}
+
+	return bbAnd( moves, pos->empty );
+}
+
+/**********************************************************/
+int isMoveInSet( BitBoard moves, Move * move )
+{
+	if( move->tile[ 0 ] < 0 || move->tile[ 0 ] >= ARRAY_BOARD_SIZE || move->tile[ 1 ] < 0 || move->tile[ 1 ] >= ARRAY_BOARD_SIZE )
+		return FALSE;
+
+	return bbTest( moves, SQUARE( move->tile[ 0 ], move->tile[ 1 ] ) );
+}
+
+/**********************************************************/
+void initUndoStack( UndoStack * stack )
+{
+	stack->top = 0;
+}
+
+/**********************************************************/
+static void pushAndPlay( Position * pos, Move * moveToDo, BitBoard flips, UndoStack * stack )
+{
+	UndoRecord * record;
+
+	assert( stack->top < MAX_UNDO );
+
+	record = &stack->record[ stack->top++ ];
+	record->move = *moveToDo;
+	record->flips = flips;
+	record->score[ WHITE ] = pos->score[ WHITE ];
+	record->score[ BLACK ] = pos->score[ BLACK ];
+	record->turn = pos->turn;
+	record->hash = pos->hash;
+
+	if( moveToDo->tile[ 0 ] == NULL_MOVE )
+	{
+		pos->turn = getOtherSide( pos->turn );
+		pos->hash ^= zobristBlackTurn;
+	}
+	else
+		applyFlips( pos, SQUARE( moveToDo->tile[ 0 ], moveToDo->tile[ 1 ] ), moveToDo->color, flips );
+
+	assert( pos->hash == computeHash( pos ) );
+}
+
+/**********************************************************/
+int makeMove( Position * pos, Move * moveToDo, UndoStack * stack )
+{
+	BitBoard flips = bbZero();
+
+	if( moveToDo->tile[ 0 ] != NULL_MOVE )
+	{
+		flips = getFlips( pos, SQUARE( moveToDo->tile[ 0 ], moveToDo->tile[ 1 ] ), moveToDo->color );
+		if( bbIsEmpty( flips ) )
+			return FALSE;
+	}
+
+	pushAndPlay( pos, moveToDo, flips, stack );
+	return TRUE;
+}
+
+/**********************************************************/
+void unmakeMove( Position * pos, UndoStack * stack )
+{
+	UndoRecord * record;
+	BitBoard flips;
+	char color, opponent;
+	int square;
+
+	assert( stack->top > 0 );
+	record = &stack->record[ --stack->top ];
+
+	pos->score[ WHITE ] = record->score[ WHITE ];
+	pos->score[ BLACK ] = record->score[ BLACK ];
+	pos->turn = record->turn;
+	pos->hash = record->hash;
+
+	if( record->move.tile[ 0 ] == NULL_MOVE )
+		return;
+
+	color = record->move.color;
+	opponent = getOtherSide( color );
+	square = SQUARE( record->move.tile[ 0 ], record->move.tile[ 1 ] );
+
+	pos->disc[ (int) color ] = bbXor( pos->disc[ (int) color ], record->flips );
+	pos->disc[ (int) opponent ] = bbXor( pos->disc[ (int) opponent ], record->flips );
+	bbClear( &pos->disc[ (int) color ], square );
+	bbSet( &pos->empty, square );
+
+	flips = record->flips;
+	while( !bbIsEmpty( flips ) )
+	{
+		int sq = bbPopLowest( &flips );
+		pos->board[ squareCell[ sq ] ] = opponent;
+	}
+	pos->board[ squareCell[ square ] ] = EMPTY;
+}
+
+/**********************************************************/
+void getMobility( Position * pos, BitBoard moves[ 2 ] )
+{
+	BitBoard white = pos->disc[ WHITE ];
+	BitBoard black = pos->disc[ BLACK ];
+	int d;
+
+	moves[ WHITE ] = bbZero();
+	moves[ BLACK ] = bbZero();
+
+	/* same fills as getLegalMoves(), both colors per direction */
+	for( d = 0; d < NUM_DIRECTIONS; d++ )
+	{
+		BitBoard whiteRun = bbAnd( fillDirection( white, black, d ), black );
+		BitBoard blackRun = bbAnd( fillDirection( black, white, d ), white );
+
+		moves[ WHITE ] = bbOr( moves[ WHITE ], stepDirection( whiteRun, d ) );
+		moves[ BLACK ] = bbOr( moves[ BLACK ], stepDirection( blackRun, d ) );
+	}
+
+	moves[ WHITE ] = bbAnd( moves[ WHITE ], pos->empty );
+	moves[ BLACK ] = bbAnd( moves[ BLACK ], pos->empty );
+}
+
+/**********************************************************/
+int generateMoves( Position * pos, char color, MoveList * list )
+{
+	return generateMovesFromSet( pos, color, getLegalMoves( pos, color ), list );
+}
+
+/**********************************************************/
+int generateMovesFromSet( Position * pos, char color, BitBoard legalMoves, MoveList * list )
+{
+	list->count = 0;
+	while( !bbIsEmpty( legalMoves ) )
+	{
+		GeneratedMove * entry = &list->moves[ list->count++ ];
+		int sq = bbPopLowest( &legalMoves );
+
+		entry->move.tile[ 0 ] = SQUARE_ROW( sq );
+		entry->move.tile[ 1 ] = SQUARE_COL( sq );
+		entry->move.color = color;
+		entry->flips = getFlips( pos, sq, color );
+	}
+
+	return list->count;
+}
+
+/**********************************************************/
+GeneratedMove * findGeneratedMove( MoveList * list, Move * move )
+{
+	int i;
+
+	for( i = 0; i < list->count; i++ )
+		if( list->moves[ i ].move.tile[ 0 ] == move->tile[ 0 ] && list->moves[ i ].move.tile[ 1 ] == move->tile[ 1 ] )
+			return &list->moves[ i ];
+
+	return NULL;
+}
+
+/**********************************************************/
+void doGeneratedMove( Position * pos, GeneratedMove * moveToDo )
+{
+	applyFlips( pos, SQUARE( moveToDo->move.tile[ 0 ], moveToDo->move.tile[ 1 ] ), moveToDo->move.color, moveToDo->flips );
+}
+
+/**********************************************************/
+void makeGeneratedMove( Position * pos, GeneratedMove * moveToDo, UndoStack * stack )
+{
+	pushAndPlay( pos, &moveToDo->move, moveToDo->flips, stack );
+}
+
+/**********************************************************/
+int positionFromText( Position * pos, const char * text )
+{
+	const char * c = text;
+	int cell = 0;
+
+	pthread_once( &tablesOnce, initBoardTables );
+
+	pos->score[ WHITE ] = 0;
+	pos->score[ BLACK ] = 0;
+
+	while( cell < BOARD_CELLS )
+	{
+		switch( *c )
+		{
+			case 'W':
+				pos->board[ cell++ ] = WHITE;
+				pos->score[ WHITE ]++;
+				break;
+			case 'B':
+				pos->board[ cell++ ] = BLACK;
+				pos->score[ BLACK ]++;
+				break;
+			case '.':
+				pos->board[ cell++ ] = EMPTY;
+				break;
+			case 'X':
+				pos->board[ cell++ ] = ILLEGAL;
+				break;
+			case ' ':
+			case '\t':
+			case '\n':
+			case '\r':
+				break;
+			default:
+				return 0;		//unknown char or text too short
+		}
+		c++;
+	}
+
+	while( *c == ' ' || *c == '\t' )
+		c++;
+
+	if( *c == 'W' )
+		pos->turn = WHITE;
+	else if( *c == 'B' )
+		pos->turn = BLACK;
+	else
+		return 0;
+	c++;
+
+	updateBitBoards( pos );
+
+	return c - text;
+}
+
+/**********************************************************/
+void positionToText( Position * pos, char text[ POSITION_TEXT_LENGTH + 1 ] )
+{
+	static const char tileChar[] = { 'W', 'B', '.', 'X' };
+	int cell;
+
+	for( cell = 0; cell < BOARD_CELLS; cell++ )
+		text[ cell ] = tileChar[ (int) pos->board[ cell ] ];
+
+	text[ BOARD_CELLS ] = ' ';
+	text[ BOARD_CELLS + 1 ] = pos->turn == WHITE ? 'W' : 'B';
+	text[ BOARD_CELLS + 2 ] = '\0';
+}
+
+/**********************************************************/
+int positionFromRecord( Position * pos, const char record[ POSITION_RECORD_SIZE ] )
+{
+	int i, j, cell;
+
+	pthread_once( &tablesOnce, initBoardTables );
+
+	pos->score[ WHITE ] = 0;
+	pos->score[ BLACK ] = 0;
+
+	//board (only the cells of the hexagon are kept)
+	for( i = 0; i < ARRAY_BOARD_SIZE; i++ )
+		for( j = 0; j < ARRAY_BOARD_SIZE; j++ )
+			if( ( cell = cellIndex[ i ][ j ] ) >= 0 )
+			{
+				if( record[ i * ARRAY_BOARD_SIZE + j ] < WHITE || record[ i * ARRAY_BOARD_SIZE + j ] > ILLEGAL )
+					return FALSE;
+				pos->board[ cell ] = record[ i * ARRAY_BOARD_SIZE + j ];
+				if( pos->board[ cell ] == WHITE || pos->board[ cell ] == BLACK )
+					pos->score[ (int) pos->board[ cell ] ]++;
+			}
+
+	//score: counted from the board above, a score byte wraps past 127 discs so it is not read
+
+	//turn
+	pos->turn = record[ ARRAY_BOARD_SIZE * ARRAY_BOARD_SIZE + 2 ];
+	if( pos->turn != WHITE && pos->turn != BLACK )
+		return FALSE;
+
+	updateBitBoards( pos );
+
+	return TRUE;
+}
+
+/**********************************************************/
+void positionToRecord( Position * pos, char record[ POSITION_RECORD_SIZE ] )
+{
+	int i, j;
+
+	//board (the whole array, padding included)
+	for( i = 0; i < ARRAY_BOARD_SIZE; i++ )
+		for( j = 0; j < ARRAY_BOARD_SIZE; j++ )
+			record[ i * ARRAY_BOARD_SIZE + j ] = getTile( pos, i, j );
+
+	//score
+	record[ ARRAY_BOARD_SIZE * ARRAY_BOARD_SIZE ] = pos->score[ WHITE ];
+	record[ ARRAY_BOARD_SIZE * ARRAY_BOARD_SIZE + 1 ] = pos->score[ BLACK ];
+
+	//turn
+	record[ ARRAY_BOARD_SIZE * ARRAY_BOARD_SIZE + 2 ] = pos->turn;
+}
@@ -3,22 +3,72 @@
 
 #include "global.h"
 #include "move.h"
+#include "bitboard.h"
 /**********************************************************/
 
 /* Position struct to store board, score and player's turn */
 typedef struct
 {
-	char board[ ARRAY_BOARD_SIZE ][ ARRAY_BOARD_SIZE ];
+	char board[ BOARD_CELLS ];								//the hex cells only, row by row (see getCell())
 	int score[ 2 ];
 	char turn;												//stores the color of the player that has the turn
+	BitBoard disc[ 2 ];										//bitboard form of board, one bitset per color
+	BitBoard empty;											//bitset of the squares that are still EMPTY
+	uint64_t hash;											//Zobrist key of the pieces and the turn
 } Position;
 
+/* The 6 hex directions, in the same order doAllDirections() walks them */
+#define NUM_DIRECTIONS 6
+
+/* Max number of moves that can be taken back, a whole game (passes included) fits */
+#define MAX_UNDO 512
+
+/* Everything makeMove() changed, so unmakeMove() can restore the position exactly */
+typedef struct
+{
+	Move move;
+	BitBoard flips;
+	int score[ 2 ];
+	char turn;
+	uint64_t hash;
+} UndoRecord;
+
+typedef struct
+{
+	UndoRecord record[ MAX_UNDO ];
+	int top;
+} UndoStack;
+
+/* Text form of a position: one char per cell ('W', 'B', '.', 'X'), in board array order,
+ * a space and the side to move ('W' or 'B'). Used by the tools that read positions from files */
+#define POSITION_TEXT_LENGTH ( BOARD_CELLS + 2 )
+
+/* Binary form of a position, the one sendPosition() and getPosition() use on the network: the whole array
+ * row by row (OUT_OF_BOUND outside the hexagon), the scores of WHITE and BLACK and the side to move, one byte each */
+#define POSITION_RECORD_SIZE ( ARRAY_BOARD_SIZE * ARRAY_BOARD_SIZE + 2 + 1 )
+
+/* Max number of legal moves in a position, never more than the cells */
+#define MAX_MOVES BOARD_CELLS
+
+/* A legal move together with the pieces it flips, so playing it needs no new scan */
+typedef struct
+{
+	Move move;
+	BitBoard flips;
+} GeneratedMove;
+
+typedef struct
+{
+	GeneratedMove moves[ MAX_MOVES ];
+	int count;
+} MoveList;
+
 
 /**********************************************************/
 void initPosition( Position * pos );
 //initializes position
 
-void printBoard( char board[ ARRAY_BOARD_SIZE ][ ARRAY_BOARD_SIZE ] );
+void printBoard( char board[ BOARD_CELLS ] );
 //prints board
 
 void printPosition( Position * pos );
@@ -43,4 +93,74 @@ int isLegal( Position * pos, short int row, short int col, char color);
 int canMove( Position * pos, char color);
 //checks if player (color) can move on that specific position.
 
+int getCell( int row, int col );
+//returns the index of (row, col) in the board array, or -1 if it is not a cell of the hexagon
+
+int getCellRow( int cell );
+int getCellCol( int cell );
+//return the array coordinates (the ones used in moves, the network and the gui) of a cell
+
+int getNeighbour( int cell, int direction );
+//returns the cell next to cell in one of the NUM_DIRECTIONS directions, or -1 at the edge
+
+char getTile( Position * pos, int row, int col );
+//returns the state of (row, col), OUT_OF_BOUND outside the hexagon
+
+void updateBitBoards( Position * pos );
+//rebuilds the bitboards and the hash of a position from its board array (call after filling the array by hand)
+
+uint64_t computeHash( Position * pos );
+//computes the Zobrist key of a position from scratch (pos->hash is kept up to date by every move function)
+
+BitBoard getFlips( Position * pos, int square, char color );
+//returns the pieces that color would flip by playing on square (empty if the move is illegal)
+
+BitBoard getLegalMoves( Position * pos, char color );
+//returns the set of all squares where color can legally play, computed in one pass over the board
+
+int isMoveInSet( BitBoard moves, Move * move );
+//checks if move (a real one, not a null move) is one of the squares in moves
+
+void initUndoStack( UndoStack * stack );
+//empties an undo stack
+
+int makeMove( Position * pos, Move * moveToDo, UndoStack * stack );
+//playes the move on position (a null move passes) and pushes what is needed to take it back
+//returns FALSE and changes nothing if the move is illegal
+
+void unmakeMove( Position * pos, UndoStack * stack );
+//takes back the last move pushed by makeMove() or makeGeneratedMove()
+
+void getMobility( Position * pos, BitBoard moves[ 2 ] );
+//computes the legal moves of both WHITE and BLACK in a single pass over the board
+
+int generateMoves( Position * pos, char color, MoveList * list );
+//fills list with every legal move of color and the pieces each one flips, returns how many there are
+
+int generateMovesFromSet( Position * pos, char color, BitBoard legalMoves, MoveList * list );
+//same as generateMoves() when the legal moves of color are already known (from getMobility())
+
+GeneratedMove * findGeneratedMove( MoveList * list, Move * move );
+//returns the entry of list for move, NULL if move is not in the list (i.e. it is illegal)
+
+void doGeneratedMove( Position * pos, GeneratedMove * moveToDo );
+//same as doMove() for a move from generateMoves(), the flips are applied as they are
+
+void makeGeneratedMove( Position * pos, GeneratedMove * moveToDo, UndoStack * stack );
+//same as makeMove() for a move from generateMoves()
+
+int positionFromText( Position * pos, const char * text );
+//reads a position in text form (whitespace between the cells is skipped), the score is counted from the board
+//returns how many chars of text were used, 0 if text is not a valid position
+
+void positionToText( Position * pos, char text[ POSITION_TEXT_LENGTH + 1 ] );
+//writes the text form of a position (null terminated)
+
+int positionFromRecord( Position * pos, const char record[ POSITION_RECORD_SIZE ] );
+//reads a position in binary form, the score is counted from the board (the score bytes wrap past 127 discs)
+//returns FALSE if a cell or the side to move is not valid
+
+void positionToRecord( Position * pos, char record[ POSITION_RECORD_SIZE ] );
+//writes the binary form of a position
+
 #endif
@@ -0,0 +1,173 @@
+#include "book.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <pthread.h>
+
+
+/* symmetryCell[ s ][ cell ] is where symmetry s moves cell, inverseCell[ s ] takes it back */
+static unsigned char symmetryCell[NUM_SYMMETRIES][BOARD_CELLS];
+static unsigned char inverseCell[NUM_SYMMETRIES][BOARD_CELLS];
+static pthread_once_t symmetriesOnce = PTHREAD_ONCE_INIT;
+
+/**
+ * The cells in cube coordinates: x = col - R, z = row - R and y = -x - z (R the radius), so the hexagon is
+ * max(|x|, |y|, |z|) <= R. A rotation by 60 degrees is (x, y, z) -> (-z, -x, -y) and swapping y and z mirrors it.
+ * Symmetry s mirrors if s >= 6 and then rotates s % 6 times
+ */
+static void initSymmetries(void)
+{
+    for (int s = 0; s < NUM_SYMMETRIES; s++) {
+        for (int cell = 0; cell < BOARD_CELLS; cell++) {
+            int x = getCellCol(cell) - HEX_BOARD_RADIUS;
+            int z = getCellRow(cell) - HEX_BOARD_RADIUS;
+            int y = -x - z;
+
+            if (s >= 6) {
+                int t = y;
+                y = z;
+                z = t;
+            }
+            for (int r = 0; r < s % 6; r++) {
+                int nx = -z, ny = -x, nz = -y;
+                x = nx;
+                y = ny;
+                z = nz;
+            }
+
+            int image = getCell(z + HEX_BOARD_RADIUS, x + HEX_BOARD_RADIUS);
+            symmetryCell[s][cell] = image;
+            inverseCell[s][image] = cell;
+        }
+    }
+}
+
+int bookMapCell(int symmetry, int cell, int inverse)
+{
+    pthread_once(&symmetriesOnce, initSymmetries);
+    return inverse ? inverseCell[symmetry][cell] : symmetryCell[symmetry][cell];
+}
+
+uint64_t bookKey(const Position *pos, int *symmetry)
+{
+    Position image;
+    uint64_t best = 0;
+
+    pthread_once(&symmetriesOnce, initSymmetries);
+
+    // computeHash() only reads the board array and the turn
+    image.turn = pos->turn;
+    for (int s = 0; s < NUM_SYMMETRIES; s++) {
+        for (int cell = 0; cell < BOARD_CELLS; cell++) {
+            image.board[symmetryCell[s][cell]] = pos->board[cell];
+        }
+        uint64_t key = computeHash(&image);
+        if (s == 0 || key < best) {
+            best = key;
+            if (symmetry != NULL) {
+                *symmetry = s;
+            }
+        }
+    }
+    return best;
+}
+
+int bookOpen(OpeningBook *book, const char *path)
+{
+    struct stat st;
+    int fd = open(path, O_RDONLY);
+
+    memset(book, 0, sizeof(OpeningBook));
+    if (fd < 0) {
+        return FALSE;
+    }
+    if (fstat(fd, &st) < 0 || (size_t) st.st_size < sizeof(BookHeader)) {
+        close(fd);
+        return FALSE;
+    }
+
+    void *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // the mapping stays valid after the file is closed
+    close(fd);
+    if (map == MAP_FAILED) {
+        return FALSE;
+    }
+
+    const BookHeader *header = (const BookHeader *) map;
+    if (memcmp(header->magic, BOOK_MAGIC, sizeof(header->magic)) != 0
+        || sizeof(BookHeader) + (size_t) header->count * sizeof(BookEntry) > (size_t) st.st_size) {
+        munmap(map, st.st_size);
+        return FALSE;
+    }
+
+    book->map = map;
+    book->size = st.st_size;
+    book->entries = (const BookEntry *) (header + 1);
+    book->count = header->count;
+    return TRUE;
+}
+
+void bookClose(OpeningBook *book)
+{
+    if (book->map != NULL) {
+        munmap(book->map, book->size);
+    }
+    memset(book, 0, sizeof(OpeningBook));
+}
+
+int bookProbe(const OpeningBook *book, const Position *pos, Move *move)
+{
+    int symmetry;
+    uint64_t key = bookKey(pos, &symmetry);
+
+    // binary search of the sorted entries
+    uint32_t low = 0, high = book->count;
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        if (book->entries[mid].key < key) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    if (low >= book->count || book->entries[low].key != key) {
+        return FALSE;
+    }
+
+    // the move is stored in the orientation of the key, turn it back to ours
+    int cell = bookMapCell(symmetry, book->entries[low].cell, TRUE);
+    move->tile[0] = getCellRow(cell);
+    move->tile[1] = getCellCol(cell);
+    move->color   = pos->turn;
+    return TRUE;
+}
+
+static int compareEntries(const void *a, const void *b)
+{
+    uint64_t ka = ((const BookEntry *) a)->key;
+    uint64_t kb = ((const BookEntry *) b)->key;
+    return ka < kb ? -1 : (ka > kb ? 1 : 0);
+}
+
+int bookWrite(const char *path, BookEntry *entries, uint32_t count)
+{
+    BookHeader header;
+    FILE *file = fopen(path, "wb");
+
+    if (file == NULL) {
+        return FALSE;
+    }
+    qsort(entries, count, sizeof(BookEntry), compareEntries);
+
+    memset(&header, 0, sizeof(BookHeader));
+    memcpy(header.magic, BOOK_MAGIC, sizeof(header.magic));
+    header.count = count;
+
+    int ok = fwrite(&header, sizeof(BookHeader), 1, file) == 1
+        && fwrite(entries, sizeof(BookEntry), count, file) == count;
+    return fclose(file) == 0 && ok;
+}
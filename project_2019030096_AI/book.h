@@ -0,0 +1,65 @@
+#ifndef _BOOK_H
+#define _BOOK_H
+
+#include "global.h"
+#include "board.h"
+#include "move.h"
+#include <stdint.h>
+#include <stddef.h>
+
+/**********************************************************/
+
+/* The hexagon looks the same after 6 rotations by 60 degrees, each with or without a mirror */
+#define NUM_SYMMETRIES 12
+
+/* First bytes of a book file */
+#define BOOK_MAGIC "HEXBOOK1"
+
+/**
+ *  One position of the book and the move to play there. A book file is a BookHeader followed by
+ *  header.count entries sorted by key, so the client can map it and search it without reading it
+ */
+typedef struct {
+    uint64_t key;                  // bookKey() of the position
+    uint8_t cell;                  // the move in the orientation of the key, a board cell (see getCell())
+    uint8_t depth;                 // depth of the search that chose it, 0 if it comes from games
+    int16_t score;                 // value of the move for the player to move (0 if it comes from games)
+    uint32_t count;                // games in which the winner played it (1 if it comes from a search)
+} BookEntry;
+
+typedef struct {
+    char magic[8];                 // BOOK_MAGIC without its '\0'
+    uint32_t count;                // entries after the header
+    uint32_t reserved;
+} BookHeader;
+
+/* A book file mapped in memory */
+typedef struct {
+    const BookEntry *entries;
+    uint32_t count;
+    void *map;
+    size_t size;
+} OpeningBook;
+
+/**********************************************************/
+
+int bookOpen(OpeningBook *book, const char *path);
+// maps the book file at path, returns FALSE if it cannot be opened or is not a book
+
+void bookClose(OpeningBook *book);
+// unmaps the book
+
+int bookProbe(const OpeningBook *book, const Position *pos, Move *move);
+// looks for pos (or one of its symmetric positions) in the book, returns TRUE and the move to play in move
+
+uint64_t bookKey(const Position *pos, int *symmetry);
+// Zobrist key of pos that is the same for all its symmetric positions: the smallest key of the NUM_SYMMETRIES
+// orientations. symmetry (can be NULL) gets the one that turns pos into the orientation of the key
+
+int bookMapCell(int symmetry, int cell, int inverse);
+// the cell where symmetry moves cell, or with inverse the cell that symmetry moves to cell
+
+int bookWrite(const char *path, BookEntry *entries, uint32_t count);
+// sorts entries by key and writes them as a book file, returns FALSE if the file cannot be written
+
+#endif
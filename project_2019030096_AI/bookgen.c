@@ -0,0 +1,369 @@
+#include "global.h"
+#include "board.h"
+#include "move.h"
+#include "search.h"
+#include "book.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <unistd.h>
+
+
+/* Bookgen: builds the opening book the client loads with -b.
+ *
+ * From searches (default): every position reachable from the start in fewer than -p plies is searched
+ * to -d plies with PVS and its best move is stored. Positions that are symmetric to one already
+ * searched have the same book key and are searched once.
+ *
+ * From games (-g file): each line of the file is one game from the start position, its moves as
+ * "row,col" separated by spaces and "pass" for a null move. For the first -p plies the moves of
+ * the winner (of both players in a draw) are counted, and the book keeps the move played most
+ * often in each position. */
+
+#define MAX_LINE 8192
+
+static BookEntry * entries = NULL;
+static uint32_t entryCount = 0;
+static uint32_t entryCapacity = 0;
+
+static TranspositionTable tt;
+
+/* Keys of the positions searched so far: open addressing with linear probing, kept at most half full.
+ * 0 marks an empty slot, so the key 0 is remembered on its own */
+static uint64_t * searchedKeys = NULL;
+static uint32_t searchedCount = 0;
+static uint32_t searchedCapacity = 0;
+static int searchedZero = FALSE;
+
+
+/**********************************************************/
+static void addEntry( uint64_t key, int cell, int depth, int score, uint32_t count )
+{
+	if( entryCount == entryCapacity )
+	{
+		entryCapacity = entryCapacity ? entryCapacity * 2 : 1024;
+		entries = realloc( entries, entryCapacity * sizeof( BookEntry ) );
+		if( entries == NULL )
+		{
+			printf( "Out of memory\n" );
+			exit( 1 );
+		}
+	}
+
+	entries[ entryCount ].key = key;
+	entries[ entryCount ].cell = cell;
+	entries[ entryCount ].depth = depth;
+	entries[ entryCount ].score = score;
+	entries[ entryCount ].count = count;
+	entryCount++;
+}
+
+/**********************************************************/
+static void insertKey( uint64_t key )
+{
+	uint32_t i = key & ( searchedCapacity - 1 );
+
+	while( searchedKeys[ i ] != 0 )
+		i = ( i + 1 ) & ( searchedCapacity - 1 );
+	searchedKeys[ i ] = key;
+}
+
+/**********************************************************/
+/* Remembers that the position with key is searched, returns FALSE if it was already */
+static int markSearched( uint64_t key )
+{
+	uint64_t * old = searchedKeys;
+	uint32_t oldCapacity = searchedCapacity, i;
+
+	if( key == 0 )
+	{
+		if( searchedZero )
+			return FALSE;
+		searchedZero = TRUE;
+		return TRUE;
+	}
+
+	for( i = key & ( searchedCapacity - 1 ); searchedCapacity > 0 && searchedKeys[ i ] != 0; i = ( i + 1 ) & ( searchedCapacity - 1 ) )
+		if( searchedKeys[ i ] == key )
+			return FALSE;
+
+	if( 2 * ( searchedCount + 1 ) > searchedCapacity )
+	{
+		searchedCapacity = searchedCapacity ? searchedCapacity * 2 : 4096;
+		searchedKeys = calloc( searchedCapacity, sizeof( uint64_t ) );
+		if( searchedKeys == NULL )
+		{
+			printf( "Out of memory\n" );
+			exit( 1 );
+		}
+		for( i = 0; i < oldCapacity; i++ )
+			if( old[ i ] != 0 )
+				insertKey( old[ i ] );
+		free( old );
+	}
+
+	insertKey( key );
+	searchedCount++;
+	return TRUE;
+}
+
+/**********************************************************/
+/* PVS over every move of pos to depth plies, returns the index of the best move in list and its value in score */
+static int searchPosition( Position * pos, MoveList * list, int depth, int * score )
+{
+	SearchInfo info;
+	int i, value, best = 0;
+
+	memcpy( &info.pos, pos, sizeof( Position ) );
+	initUndoStack( &info.undo );
+	memset( &info.stats, 0, sizeof( SearchStats ) );
+	info.deadline = 0;
+	info.aborted = FALSE;
+	info.tt = &tt;
+	info.stop = NULL;
+
+	ttNewSearch( &tt );
+	*score = -SEARCH_INFINITY;
+	for( i = 0; i < list->count; i++ )
+	{
+		makeGeneratedMove( &info.pos, &list->moves[ i ], &info.undo );
+		value = -principalVariationSearch( &info, depth - 1, -SEARCH_INFINITY, -*score );
+		unmakeMove( &info.pos, &info.undo );
+
+		if( value > *score )
+		{
+			*score = value;
+			best = i;
+		}
+	}
+
+	return best;
+}
+
+/**********************************************************/
+/* Searches pos and every position after it up to plies plies from the start */
+static void expandSearch( Position * pos, int ply, int plies, int depth )
+{
+	MoveList list;
+	Position child;
+	Move passMove;
+	uint64_t key;
+	int symmetry, best, score, i;
+
+	if( ply >= plies )
+		return;
+
+	generateMoves( pos, pos->turn, &list );
+	if( list.count == 0 )
+	{
+		if( !canMove( pos, getOtherSide( pos->turn ) ) )
+			return;		//game over
+
+		child = *pos;
+		passMove.tile[ 0 ] = NULL_MOVE;
+		passMove.color = pos->turn;
+		doMove( &child, &passMove );
+		expandSearch( &child, ply + 1, plies, depth );
+		return;
+	}
+
+	key = bookKey( pos, &symmetry );
+	if( !markSearched( key ) )
+		return;		//a symmetric position was searched, so were the ones after it
+
+	best = searchPosition( pos, &list, depth, &score );
+	addEntry( key, bookMapCell( symmetry, getCell( list.moves[ best ].move.tile[ 0 ], list.moves[ best ].move.tile[ 1 ] ), FALSE ), depth, score, 1 );
+
+	printf( "ply %d: %u positions\r", ply, entryCount );
+	fflush( stdout );
+
+	for( i = 0; i < list.count; i++ )
+	{
+		child = *pos;
+		doGeneratedMove( &child, &list.moves[ i ] );
+		expandSearch( &child, ply + 1, plies, depth );
+	}
+}
+
+/**********************************************************/
+static int compareKeyCell( const void * a, const void * b )
+{
+	const BookEntry * x = a;
+	const BookEntry * y = b;
+
+	if( x->key != y->key )
+		return x->key < y->key ? -1 : 1;
+	return (int) x->cell - (int) y->cell;
+}
+
+/**********************************************************/
+/* Reads the games, then keeps for each position the move with the most entries */
+static int readGames( const char * fileName, int plies )
+{
+	FILE * file;
+	char line[ MAX_LINE ];
+	Position pos;
+	Move moves[ MAX_UNDO ];
+	char * token;
+	int lineNumber = 0, games = 0, count, i, winner, symmetry, row, col;
+	uint32_t first, last, kept, bestRun;
+
+	if( ( file = fopen( fileName, "r" ) ) == NULL )
+	{
+		printf( "Could not open %s\n", fileName );
+		return FALSE;
+	}
+
+	while( fgets( line, MAX_LINE, file ) != NULL )
+	{
+		lineNumber++;
+
+		if( line[ 0 ] == '#' || line[ strspn( line, " \t\r\n" ) ] == '\0' )
+			continue;
+
+		/* play the whole game first, we need its winner */
+		initPosition( &pos );
+		count = 0;
+		for( token = strtok( line, " \t\r\n" ); token != NULL && count < MAX_UNDO; token = strtok( NULL, " \t\r\n" ) )
+		{
+			moves[ count ].color = pos.turn;
+			if( strcmp( token, "pass" ) == 0 )
+				moves[ count ].tile[ 0 ] = NULL_MOVE;
+			else if( sscanf( token, "%d,%d", &row, &col ) == 2 )
+			{
+				moves[ count ].tile[ 0 ] = row;
+				moves[ count ].tile[ 1 ] = col;
+			}
+			else
+				break;
+
+			if( moves[ count ].tile[ 0 ] == NULL_MOVE ? canMove( &pos, pos.turn ) : !isLegalMove( &pos, &moves[ count ] ) )
+				break;
+
+			doMove( &pos, &moves[ count ] );
+			count++;
+		}
+		if( token != NULL )
+		{
+			printf( "%s:%d: illegal move %s, game skipped\n", fileName, lineNumber, token );
+			continue;
+		}
+
+		winner = pos.score[ WHITE ] > pos.score[ BLACK ] ? WHITE : ( pos.score[ BLACK ] > pos.score[ WHITE ] ? BLACK : EMPTY );
+
+		initPosition( &pos );
+		for( i = 0; i < count && i < plies; i++ )
+		{
+			if( moves[ i ].tile[ 0 ] != NULL_MOVE && ( winner == EMPTY || winner == moves[ i ].color ) )
+				addEntry( bookKey( &pos, &symmetry ), bookMapCell( symmetry, getCell( moves[ i ].tile[ 0 ], moves[ i ].tile[ 1 ] ), FALSE ), 0, 0, 1 );
+			doMove( &pos, &moves[ i ] );
+		}
+		games++;
+	}
+	fclose( file );
+
+	/* one run of entries per (position, move), the longest run of each position wins */
+	qsort( entries, entryCount, sizeof( BookEntry ), compareKeyCell );
+	kept = 0;
+	for( first = 0; first < entryCount; first = last )
+	{
+		bestRun = 0;
+		for( last = first; last < entryCount && entries[ last ].key == entries[ first ].key; )
+		{
+			uint32_t run = last;
+			while( run < entryCount && entries[ run ].key == entries[ last ].key && entries[ run ].cell == entries[ last ].cell )
+				run++;
+			if( run - last > bestRun )
+			{
+				bestRun = run - last;
+				entries[ kept ] = entries[ last ];
+				entries[ kept ].count = bestRun;
+			}
+			last = run;
+		}
+		kept++;
+	}
+	entryCount = kept;
+
+	printf( "%d games\n", games );
+	return TRUE;
+}
+
+/**********************************************************/
+int main( int argc, char **argv )
+{
+	int c;
+	int plies = 4;
+	int depth = 8;
+	char * gamesFile = NULL;
+	char * outFile = "book.bin";
+	Position pos;
+
+	opterr = 0;
+
+	while( ( c = getopt( argc, argv, "p:d:g:o:h" ) ) != -1 )
+		switch( c )
+		{
+			case 'h':
+				printf( "[-p plies (4)] [-d search depth (8)] [-g games_file (instead of searching)] [-o book_file (book.bin)]\n" );
+				return 0;
+			case 'p':
+				plies = atoi( optarg );
+				break;
+			case 'd':
+				depth = atoi( optarg );
+				break;
+			case 'g':
+				gamesFile = optarg;
+				break;
+			case 'o':
+				outFile = optarg;
+				break;
+			case '?':
+				if( optopt == 'p' || optopt == 'd' || optopt == 'g' || optopt == 'o' )
+					printf( "Option -%c requires an argument.\n", ( char ) optopt );
+				else if( isprint( optopt ) )
+					printf( "Unknown option -%c\n", ( char ) optopt );
+				else
+					printf( "Unknown option character -%c\n", ( char ) optopt );
+				return 1;
+			default:
+			return 1;
+		}
+
+	if( plies < 1 || depth < 1 || depth > MAX_SEARCH_DEPTH )
+	{
+		printf( "The plies must be at least 1 and the depth between 1 and %d\n", MAX_SEARCH_DEPTH );
+		return 1;
+	}
+
+	if( gamesFile != NULL )
+	{
+		if( !readGames( gamesFile, plies ) )
+			return 1;
+	}
+	else
+	{
+		if( !ttInit( &tt, TT_DEFAULT_MB ) )
+		{
+			printf( "Could not allocate the transposition table\n" );
+			return 1;
+		}
+		initPosition( &pos );
+		expandSearch( &pos, 0, plies, depth );
+		printf( "\n" );
+		ttFree( &tt );
+		free( searchedKeys );
+	}
+
+	if( !bookWrite( outFile, entries, entryCount ) )
+	{
+		printf( "Could not write %s\n", outFile );
+		return 1;
+	}
+
+	printf( "%u positions written to %s\n", entryCount, outFile );
+	free( entries );
+	return 0;
+}
@@ -2,6 +2,11 @@
 #include "board.h"
 #include "move.h"
 #include "comm.h"
+#include "search.h"
+#include "ponder.h"
+#include "endgame.h"
+#include "book.h"
+#include "stats.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
@@ -10,11 +15,6 @@
 #include <string.h>  
 
 
-
-#define MAX_CHILDREN 300   	// max number of available moves at each positio 
-#define ΜΑΧ_DEPTH 3     	// max depth allowed for minimax algo
-
-
 Position gamePosition;     
 Move moveReceived;         
 Move myMove;               
@@ -23,494 +23,46 @@ int mySocket;
 char msg;
 
 // available names to change depending on the algorithm used
-static const char *algorithmNames[3] = {
+static const char *algorithmNames[NUM_ALGORITHMS] = {
     "SimpleMinimax",
     "AΒMinimax",
-    "AΒOrdering"
+    "AΒOrdering",
+    "Negamax",
+    "YBWC",
+    "PVS"
 };
 char agentName[50] = "MultiMinimaxPlayer";
 
 // variable to choose the algo given by the user
 int algorithmChoice = 0;
 
-// variables to measure execution time, for each lagorithm usedthere is a slot
-static double totalTimeAlg[3] = {0.0, 0.0, 0.0};
-static int    moveCountAlg[3] = {0,   0,   0};
-
-/**
- * 	Struct treeNode used for searching in a tree form 
- * 	It represents a certain state of a game given the position on the hextable,
- *  the last move led to it, the next available moves
- * 
- */
-
-typedef struct treeNode {
-    Position pos;                				// current position in the table
-    Move lastMove;               				// last move that brought us here
-    int valuation;               				// value of the certain node
-    struct treeNode *children[MAX_CHILDREN];	// next available states (nodes)
-    int childCount;								// number of children of current node
-} treeNode;
-
-treeNode* createTreeNode(const Position *p, const Move *move);
-void freeTree(treeNode *node);
-int evaluatePosition(const Position *pos, char maximizingColor);
-int expandNode(treeNode *node, char currentColor);
-int simpleMinimax(treeNode *node, int depth, char maximizingColor);
-int alphaBetaMinimax(treeNode *node, int depth, int alpha, int beta, char maximizingColor);
-int alphaBetaMinimaxWithOrdering(treeNode *node, int depth, int alpha, int beta, char maximizingColor);
-Move findBestMove(Position *rootPos, char myCol, int alg);
-
-treeNode* createTreeNode(const Position *p, const Move *move)
-
-/**
- * Create a new node given the position and the move that led to it
- */
-{	
-	
-	// create new node
-	treeNode* node = (treeNode*) malloc(sizeof(treeNode));
-
-	// save the position given
-    memcpy(&node->pos, p, sizeof(Position));  
-
-	// check if this node is a root
-    if (move != NULL) {
-		// if not save the move
-        node->lastMove = *move;
-    } else {
-		// if yes set last move to NULL
-        node->lastMove.tile[0] = NULL_MOVE;
-        node->lastMove.color   = p->turn; 
-    }
-
-	// set vals to zero
-    node->valuation = 0;
-    node->childCount = 0;
-    for (int i = 0; i < MAX_CHILDREN; i++)
-        node->children[i] = NULL;
-
-    return node;
-}
-/**
- * Free the tree
- */
-void freeTree(treeNode *node)
-{
-    if (!node) return;
-    for (int i = 0; i < node->childCount; i++) {
-        if (node->children[i]) {
-            freeTree(node->children[i]);
-            node->children[i] = NULL;
-        }
-    }
-    free(node);
-}
-
-/**
- * Check if a given position is terminal by checking if there are any legal moves remaining
- * Basicaly check if  can move is false  for both players collors
- */
-int isTerminalPosition(const Position *position)
-{
-    if (!canMove((Position*)position, WHITE) && !canMove((Position*)position, BLACK)) {
-        return 1;
-    }
-    return 0;
-}
-
-/**
- * Simple evaluation of position as given in exercise's decsription
- * we evaluate a certain position by the difference of our and opponet's score
- */
-int evaluatePosition(const Position *position, char ourColor)
-{	
-	// get my score
-    int myScore  = position->score[(int) ourColor];
-	// get opponets score
-    int oppScore = position->score[(int) getOtherSide(ourColor)];
-    return (myScore - oppScore);
-}
-
-
-/**
- * Basically scans every empty space in the board and checks for legal moves 
- * If a move is legal we create a new node  representing the new state
- * In order to create the new state we save the current position in the new node and perform the needed move
- * 
- * Returns the number of children created for the given node
- */
-int expandNode(treeNode *node, char currentColor)
-{
-	// save the number of childen created
-    int count = 0;
-    // Scan every space in the table
-    for (int i = 0; i < ARRAY_BOARD_SIZE; i++) {
-        for (int j = 0; j < ARRAY_BOARD_SIZE; j++) {
-			// check if the position is empty
-            if (node->pos.board[i][j] == EMPTY) {
-				//  create a temporary  move that will lead to it
-                Move move;
-                move.tile[0] = i;
-                move.tile[1] = j;
-                move.color   = currentColor;
-
-				// check if the move is legal
-                if ( isLegalMove((Position*)&node->pos, &move) ) {
-                    // if yes create a new position with the current position and the move given
-                    Position newPos;
-                    memcpy(&newPos, &node->pos, sizeof(Position));
-                    doMove(&newPos, &move);  
-
-                    // create new child (new node state)
-                    treeNode *child = createTreeNode(&newPos, &move);
-
-                    // connect the new child to the current node
-                    node->children[node->childCount++] = child;
-
-					// keep track of the children number created
-                    count++;
-
-               
-                }
-            }
-        }
-    }
-    return count;
-}
-
-
-/**
- * Simple Minimax algo
- * The first call is always the maximizer 
- */
-int simpleMinimax(treeNode *node, int depth, char maximizingColor)
-{
-	// define curent player
-    char currentPlayer = node->pos.turn;
-
-    // check if a position is terminal 
-	// if yes return its value
-    if (depth == 0 || isTerminalPosition(&node->pos)) {
-        node->valuation = evaluatePosition(&node->pos, maximizingColor);
-        return node->valuation;
-    }
-
-	// expand the nodes childrens
-    int childCount = expandNode(node, currentPlayer);
-
-	// check if there are no available moves (children)
-    if (childCount == 0) {  
-		// check if its not  a terminal position
-        if (!isTerminalPosition(&node->pos)) { 
-			// in case its not a terminal position and no available moves 
-			// we have to simulate the other players turn since we lose ours
-			// create a temporary position switching the turn to the other player
-            Position passPos;
-            memcpy(&passPos, &node->pos, sizeof(Position));
-            passPos.turn = getOtherSide(passPos.turn);
-            
-            // create a temporary node to call a new minimax for our next turn
-            treeNode *tempNode = createTreeNode(&passPos, NULL);
-
-			// call minimax to find oure next turns value
-			node->valuation = simpleMinimax(tempNode, depth-1, maximizingColor);
-
-			freeTree(tempNode);
-			
-            return node-> valuation;
-        }
-        // if its a terminal position just return is valuation
-        node->valuation = evaluatePosition(&node->pos, maximizingColor);
-        return node->valuation;
-    }
-
-	// case of max player
-    if (currentPlayer == maximizingColor) {
-        
-		// set best val to -oo
-        int bestVal = INT_MIN;
-		// call Minimax for every child recursively
-        for (int i = 0; i < node->childCount; i++) {
-			
-            treeNode *child = node->children[i];
-            int value = simpleMinimax(child, depth-1, maximizingColor);
-
-			// update best value found
-            if (value > bestVal) {
-                bestVal = value;
-    		}
-        }
-        node->valuation = bestVal;
-        return bestVal;
-	
-    } 
-	// case of min player
-	else {
-        int bestVal = INT_MAX;
-        for (int i = 0; i < node->childCount; i++) {
-
-            treeNode *child = node->children[i];
-            int value = simpleMinimax(child, depth-1, maximizingColor);
-            if (value < bestVal) {
-                bestVal = value;
-            }
-        }
-        node->valuation = bestVal;
-        return bestVal;
-    }
-}
-
-/**
- * Minimax algo with alpa-beta prunning.
- * Difference is we do not call minimax algo for every child recursively
- * Instead we keep values a,b update them and
- * if we find a value that we know it wont pe picked by the opponent 
- * we cut the remaining childs of the node 
- */
-int alphaBetaMinimax(treeNode *node, int depth, int alpha, int beta, char maximizingColor)
-{	
-	// define curent player
-    char currentPlayer = node->pos.turn;
-
-	// check if a position is terminal 
-	// if yes return its value
-    if (depth == 0 || isTerminalPosition(&node->pos)) {
-        node->valuation = evaluatePosition(&node->pos, maximizingColor);
-        return node->valuation;
-    }
-
-	// expand the nodes childrens
-    int childCount = expandNode(node, currentPlayer);
-	// check if there are no available moves (children)
-    if (childCount == 0) {
-        // check if its not  a terminal position
-        if (!isTerminalPosition(&node->pos)) {
-			// in case its not a terminal position and no available moves 
-			// we have to simulate the other players turn since we lose ours
-			// create a temporary position switching the turn to the other player
-            Position passPos;
-            memcpy(&passPos, &node->pos, sizeof(Position));
-            passPos.turn = getOtherSide(passPos.turn);
-
-			// create a temporary node to call a new minimax for our next turn
-            treeNode *tempNode = createTreeNode(&passPos, NULL);
-
-			// call minimax to find oure next turns value
-			node->valuation = alphaBetaMinimax(tempNode, depth-1, alpha, beta, maximizingColor);
-
-			freeTree(tempNode);
-
-			return node->valuation;
-        }
-        // if its a terminal position just return is valuation
-        node->valuation = evaluatePosition(&node->pos, maximizingColor);
-        return node->valuation;
-    }
-
-	// case of max player
-    if (currentPlayer == maximizingColor) {
-		//  set best val to -oo
-        int bestVal = INT_MIN;
-		// call a-b pruning for  every child recursively until we stop when we find a smaller value of beta
-        for (int i=0; i<node->childCount; i++) {
-            treeNode *child = node->children[i];
-            int value = alphaBetaMinimax(child, depth-1, alpha, beta, maximizingColor);
-            if (value > bestVal) {
-                bestVal = value;
-            }
-            if (value > alpha) {
-                alpha = value;
-            }
-            // no need to search anymore cause we want select this case
-            if (beta <= alpha) {
-                break;
-            }
-        }
-        node->valuation = bestVal;
-        return bestVal;
-    } 
-	// case of min player
-	else {
-        int bestVal = INT_MAX;
-        for (int i=0; i<node->childCount; i++) {
-            treeNode *child = node->children[i];
-            int value = alphaBetaMinimax(child, depth-1, alpha, beta, maximizingColor);
-            if (value < bestVal) {
-                bestVal = value;
-            }
-            if (value < beta) {
-                beta = value;
-            }
-            // no need to search anymore cause we want select this case
-            if (beta <= alpha) {
-                break;
-            }
-        }
-        node->valuation = bestVal;
-        return bestVal;
-    }
-}
-
-/**
- * A simple yet effective change on the classic a-b pruning.
- * Before we perform the a-b pruning algo we order the childrens of the node accordingly to promote pruning.
- * For a max player we move first the childrens with the biggest  valuation
- * For a min player we move first the childrens with the lowest valuation
- * 
- */
-int alphaBetaMinimaxWithOrdering(treeNode *node, int depth, int alpha, int beta, char maximizingColor)
-{
-    // define curent player
-    char currentPlayer = node->pos.turn;
-
-	// check if a position is terminal 
-	// if yes return its value
-    if (depth == 0 || isTerminalPosition(&node->pos)) {
-        node->valuation = evaluatePosition(&node->pos, maximizingColor);
-        return node->valuation;
-    }
-
-	// expand the nodes childrens
-    int childCount = expandNode(node, currentPlayer);
-	// check if there are no available moves (children)
-    if (childCount == 0) {
-        // check if its not  a terminal position
-        if (!isTerminalPosition(&node->pos)) {
-			// in case its not a terminal position and no available moves 
-			// we have to simulate the other players turn since we lose ours
-			// create a temporary position switching the turn to the other player
-            Position passPos;
-            memcpy(&passPos, &node->pos, sizeof(Position));
-            passPos.turn = getOtherSide(passPos.turn);
-
-			// create a temporary node to call a new minimax for our next turn
-            treeNode *tempNode = createTreeNode(&passPos, NULL);
-
-			// call minimax to find oure next turns value
-			node->valuation = alphaBetaMinimaxWithOrdering(tempNode, depth-1, alpha, beta, maximizingColor);
-
-			freeTree(tempNode);
-
-			return node->valuation;
-        }
-        // if its a terminal position just return is valuation
-        node->valuation = evaluatePosition(&node->pos, maximizingColor);
-        return node->valuation;
-    }
-
-    //  Move Ordering 
-    // first calculate the valuation for each children
-    for (int i=0; i<node->childCount; i++) {
-        treeNode *c = node->children[i];
-        c->valuation = evaluatePosition(&c->pos, maximizingColor);
-    }
-    // order chids with decreasing order to promote pruning
-    if (currentPlayer == maximizingColor) {
-        for (int i=0; i<node->childCount-1; i++) {
-            for (int j=i+1; j<node->childCount; j++) {
-                if (node->children[i]->valuation < node->children[j]->valuation) {
-                    treeNode* tmp = node->children[i];
-                    node->children[i] = node->children[j];
-                    node->children[j] = tmp;
-                }
-            }
-        }
-    }
-    // order childs with increasing order to promote prunng
-    else {
-        for (int i=0; i<node->childCount-1; i++) {
-            for (int j=i+1; j<node->childCount; j++) {
-                if (node->children[i]->valuation > node->children[j]->valuation) {
-                    treeNode* tmp = node->children[i];
-                    node->children[i] = node->children[j];
-                    node->children[j] = tmp;
-                }
-            }
-        }
-    }
-
-    // case of max player
-    if (currentPlayer == maximizingColor) {
-        //  set best val to -oo
-        int bestVal = INT_MIN;
-        // call a-b pruning for  every child recursively until we stop when we find a smaller value of beta
-        for (int i=0; i<node->childCount; i++) {
-            treeNode *child = node->children[i];
-            int value = alphaBetaMinimaxWithOrdering(child, depth-1, alpha, beta, maximizingColor);
-            if (value > bestVal) bestVal = value;
-            if (value > alpha) alpha = value;
-            // no need to search anymore cause we want select this case
-            if (beta <= alpha) {
-                break;
-            }
-        }
-        node->valuation = bestVal;
-        return bestVal;
-    }
-    // case of min player
-    else {
-        int bestVal = INT_MAX;
-        for (int i=0; i<node->childCount; i++) {
-            treeNode *child = node->children[i];
-            int value = alphaBetaMinimaxWithOrdering(child, depth-1, alpha, beta, maximizingColor);
-            if (value < bestVal) bestVal = value;
-            if (value < beta) beta = value;
-            // κλάδεμα
-            if (beta <= alpha) {
-                break;
-            }
-        }
-        node->valuation = bestVal;
-        return bestVal;
-    }
-}
+// transposition table of the negamax search, its size is given by the user (-H)
+TranspositionTable transpositionTable;
+int hashSizeMB = TT_DEFAULT_MB;
 
+// depth, time limit, threads and endgame of the search, given by the user (-d, -m, -t, -e)
+SearchOptions searchOptions = { ΜΑΧ_DEPTH, 0, 1, &transpositionTable, NULL, ENDGAME_DEFAULT_EMPTIES };
 
+// opening book given by the user (-b), its moves are played without searching
+static OpeningBook openingBook;
+static int bookLoaded = FALSE;
+static int bookMoves = 0;
 
-Move findBestMove(Position *rootPos, char myCol, int alg)
-{
-    treeNode* root = createTreeNode(rootPos, NULL);
-
-    int bestVal = 0;
-    switch (alg) {
-        case 0:
-            bestVal = simpleMinimax(root, ΜΑΧ_DEPTH, myCol);
-            break;
-        case 1:
-            bestVal = alphaBetaMinimax(root, ΜΑΧ_DEPTH, INT_MIN, INT_MAX, myCol);
-            break;
-        case 2:
-            bestVal = alphaBetaMinimaxWithOrdering(root, ΜΑΧ_DEPTH, INT_MIN, INT_MAX, myCol);
-            break;
-        default:
-            bestVal = alphaBetaMinimax(root, ΜΑΧ_DEPTH, INT_MIN, INT_MAX, myCol);
-            break;
-    }
-
-    // now we have to find the child that led to the best valuation calculated
-    Move bestMove;
-    bestMove.tile[0] = NULL_MOVE;
-
-    // first check it they were no available moves so return NULL
-    if (root->childCount == 0) {
-        freeTree(root);
-        return bestMove;
-    }
-
+// search on the opponent's time (-P) and how often it predicted the reply
+int ponderEnabled = FALSE;
+static Ponder ponder;
+static int ponderPredictions = 0;
+static int ponderHits = 0;
+static unsigned long long ponderNodes = 0;
 
-    // search every children to find the one with the best value calculated 
-    for (int i=0; i < root->childCount; i++) {
-        if (root->children[i]->valuation == bestVal) {
-            bestMove = root->children[i]->lastMove;
-            break;
-        }
-    }
-
-    freeTree(root);
-    return bestMove;
-}
+// counters of every search of the game, written to a CSV or JSON file given by the user (-S)
+static MatchStats matchStats;
+static char *statsFile = NULL;
+static int myMoves = 0;
 
+// variables to measure the wall time of our moves (monotonic clock), for each lagorithm usedthere is a slot
+static double totalTimeAlg[NUM_ALGORITHMS] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+static int    moveCountAlg[NUM_ALGORITHMS] = {0,   0,   0,   0,   0,   0};
 
 
 int main(int argc, char **argv)
@@ -521,7 +73,9 @@ int main(int argc, char **argv)
     char *ip = "127.0.0.1";
     char *port = "6002";
 
-    while( ( c = getopt ( argc, argv, "i:p:a:h" ) ) != -1 )
+    int depthGiven = FALSE;
+
+    while( ( c = getopt ( argc, argv, "i:p:a:d:m:H:t:e:b:PS:h" ) ) != -1 )
     {
         switch( c )
         {
@@ -531,6 +85,18 @@ int main(int argc, char **argv)
                 printf("       0 => Simple Minimax (no alpha-beta)\n");
                 printf("       1 => Alpha-Beta Minimax\n");
                 printf("       2 => Alpha-Beta with Move Ordering\n");
+                printf("       3 => Negamax (alpha-beta, no tree)\n");
+                printf("       4 => YBWC (alpha-beta with ordering, split between the threads)\n");
+                printf("       5 => PVS (null windows and aspiration windows)\n");
+                printf("   -d  : search depth (default %d), the deepest iteration for negamax, YBWC and PVS\n", ΜΑΧ_DEPTH);
+                printf("   -m  : time for each move in ms, negamax, YBWC and PVS deepen until it runs out (default no limit)\n");
+                printf("   -H  : size of the transposition table of negamax and PVS in MB (default %d)\n", TT_DEFAULT_MB);
+                printf("   -t  : threads of the negamax, YBWC and PVS searches (default 1)\n");
+                printf("   -e  : solve the game exactly with this many empty cells or less, win/loss/draw %d earlier (default %d, 0 never)\n",
+                    ENDGAME_WLD_EXTRA, ENDGAME_DEFAULT_EMPTIES);
+                printf("   -b  : opening book file made by bookgen, its positions are played from it\n");
+                printf("   -P  : ponder, negamax and PVS search the expected reply while the opponent thinks\n");
+                printf("   -S  : write the search statistics of every move to this file, JSON if it ends in .json, else CSV\n");
                 return 0;
             case 'i':
                 ip = optarg;
@@ -540,13 +106,58 @@ int main(int argc, char **argv)
                 break;
 			case 'a':
                 algorithmChoice = atoi(optarg);
-                if (algorithmChoice < 0 || algorithmChoice > 2) {
-					printf(" you should have selected a number from { 0,1,2} ");
+                if (algorithmChoice < 0 || algorithmChoice >= NUM_ALGORITHMS) {
+					printf(" you should have selected a number from { 0,1,2,3,4,5} ");
                     algorithmChoice = 0; // default
                 }
                 break;
+            case 'd':
+                searchOptions.maxDepth = atoi(optarg);
+                if (searchOptions.maxDepth < 1 || searchOptions.maxDepth > MAX_SEARCH_DEPTH) {
+                    printf(" the depth should be between 1 and %d ", MAX_SEARCH_DEPTH);
+                    searchOptions.maxDepth = ΜΑΧ_DEPTH; // default
+                }
+                depthGiven = TRUE;
+                break;
+            case 'm':
+                searchOptions.timeLimitMs = atoi(optarg);
+                if (searchOptions.timeLimitMs < 0) {
+                    searchOptions.timeLimitMs = 0; // no limit
+                }
+                break;
+            case 'H':
+                hashSizeMB = atoi(optarg);
+                if (hashSizeMB < 1) {
+                    hashSizeMB = TT_DEFAULT_MB; // default
+                }
+                break;
+            case 't':
+                searchOptions.threads = atoi(optarg);
+                if (searchOptions.threads < 1) {
+                    searchOptions.threads = 1; // default
+                }
+                break;
+            case 'e':
+                searchOptions.endgameEmpties = atoi(optarg);
+                if (searchOptions.endgameEmpties < 0) {
+                    searchOptions.endgameEmpties = 0; // never
+                }
+                break;
+            case 'b':
+                if (!bookOpen(&openingBook, optarg)) {
+                    fprintf(stderr, "Could not open the opening book %s\n", optarg);
+                    return 1;
+                }
+                bookLoaded = TRUE;
+                break;
+            case 'P':
+                ponderEnabled = TRUE;
+                break;
+            case 'S':
+                statsFile = optarg;
+                break;
             case '?':
-                if( optopt == 'i' || optopt == 'p' )
+                if( optopt == 'i' || optopt == 'p' || optopt == 'a' || optopt == 'd' || optopt == 'm' || optopt == 'H' || optopt == 't' || optopt == 'e' || optopt == 'b' || optopt == 'S' )
                     printf( "Option -%c requires an argument.\n", ( char ) optopt );
                 else if( isprint( optopt ) )
                     printf( "Unknown option -%c\n", ( char ) optopt );
@@ -558,6 +169,24 @@ int main(int argc, char **argv)
         }
     }
 
+    // with a time limit and no depth, negamax, YBWC and PVS deepen for as long as the time allows
+    if (algorithmChoice >= ALG_NEGAMAX && searchOptions.timeLimitMs > 0 && !depthGiven) {
+        searchOptions.maxDepth = MAX_SEARCH_DEPTH;
+    }
+
+    // only the searches that keep their results in the table gain from a search done before
+    if (ponderEnabled && !canPonder(algorithmChoice)) {
+        printf("Pondering needs negamax (-a 3) or PVS (-a 5), playing without it\n");
+        ponderEnabled = FALSE;
+    }
+
+    if (!ttInit(&transpositionTable, hashSizeMB)) {
+        fprintf(stderr, "Could not allocate a transposition table of %d MB\n", hashSizeMB);
+        return 1;
+    }
+
+    statsInit(&matchStats);
+
     // set agent name that we will use given the algo the user gave us
     strcpy(agentName, algorithmNames[algorithmChoice]);
 
@@ -575,6 +204,7 @@ int main(int argc, char **argv)
                 break;
 
             case NM_NEW_POSITION:
+                stopPondering(&ponder, NULL);
                 getPosition(&gamePosition, mySocket);
                 printPosition(&gamePosition);
                 break;
@@ -590,6 +220,15 @@ int main(int argc, char **argv)
             case NM_PREPARE_TO_RECEIVE_MOVE:
                 getMove(&moveReceived, mySocket);
                 moveReceived.color = getOtherSide(myColor);
+
+                // the ponder search stops either way, on a hit its iterations wait for us in the table
+                if (ponder.running) {
+                    int hit = stopPondering(&ponder, &moveReceived);
+                    ponderHits += hit;
+                    ponderNodes += ponder.report.stats.nodes;
+                    printf("Ponder %s: depth %d, %llu nodes\n", hit ? "hit" : "miss", ponder.report.depth, ponder.report.stats.nodes);
+                }
+
                 doMove(&gamePosition, &moveReceived);
                 printPosition(&gamePosition);
                 break;
@@ -597,15 +236,27 @@ int main(int argc, char **argv)
             case NM_REQUEST_MOVE:
             {
                 myMove.color = myColor;
-                
-                // keep track of time
-                clock_t startTime = clock();
-                
+                myMoves++;
+
+                // keep track of time, the phases of the move are split after it is sent
+                double requestTime = getTimeSeconds();
+                MoveTiming timing;
+                SearchReport report;
+                int searched = FALSE;
+                memset(&timing, 0, sizeof(MoveTiming));
+
                 // no available moves so return null
                 if (!canMove(&gamePosition, myColor)) {
                     myMove.tile[0] = NULL_MOVE;
+                } else if (bookLoaded && bookProbe(&openingBook, &gamePosition, &myMove) && isLegalMove(&gamePosition, &myMove)) {
+                    printf("Book move\n");
+                    bookMoves++;
                 } else {
-                    myMove = findBestMove(&gamePosition, myColor, algorithmChoice);
+                    myMove = findBestMove(&gamePosition, myColor, algorithmChoice, &searchOptions, &report);
+                    searched = TRUE;
+
+                    statsPrintSearch(stdout, &report);
+                    statsRecordMove(&matchStats, myMoves, algorithmChoice, &report);
 
                     // fallback to a random move if we cannot find a legal one
                     if (myMove.tile[0] != NULL_MOVE && !isLegalMove(&gamePosition, &myMove)) {
@@ -614,7 +265,7 @@ int main(int argc, char **argv)
                         for (;;) {
                             int rr = rand() % ARRAY_BOARD_SIZE;
                             int cc = rand() % ARRAY_BOARD_SIZE;
-                            if (gamePosition.board[rr][cc] == EMPTY) {
+                            if (getTile(&gamePosition, rr, cc) == EMPTY) {
                                 myMove.tile[0] = rr;
                                 myMove.tile[1] = cc;
                                 if ( isLegalMove(&gamePosition, &myMove) ) {
@@ -629,26 +280,36 @@ int main(int argc, char **argv)
                     }
                 }
 
-                clock_t endTime = clock();
-                double elapsedSec = (double)(endTime - startTime) / CLOCKS_PER_SEC;
-
-                // update time and move counters
-                totalTimeAlg[algorithmChoice] += elapsedSec;
-                moveCountAlg[algorithmChoice]++;
+                double chosenTime = getTimeSeconds();
+                statsSplitSearch(&timing, searched ? &report : NULL, chosenTime - requestTime, searchOptions.threads);
 
                 sendMove(&myMove, mySocket);
+                double sentTime = getTimeSeconds();
+                timing.seconds[MOVE_PHASE_SEND] = sentTime - chosenTime;
+                timing.seconds[MOVE_PHASE_TOTAL] = sentTime - requestTime;
+
                 doMove(&gamePosition, &myMove);
                 printPosition(&gamePosition);
+                timing.seconds[MOVE_PHASE_PRINT] = getTimeSeconds() - sentTime;
+                statsRecordTiming(&matchStats, &timing);
+
+                // update time and move counters
+                totalTimeAlg[algorithmChoice] += timing.seconds[MOVE_PHASE_TOTAL];
+                moveCountAlg[algorithmChoice]++;
+
+                if (ponderEnabled && startPondering(&ponder, &gamePosition, algorithmChoice, &searchOptions)) {
+                    ponderPredictions++;
+                }
 
-                // printf(" Move time: %.3f sec\n", elapsedSec);
+                // printf(" Move time: %.3f sec\n", timing.seconds[MOVE_PHASE_TOTAL]);
                 break;
             }
 
             case NM_QUIT:
-
+                stopPondering(&ponder, NULL);
 
                 printf("\n--- Game finished. Statistics ---\n");
-                for (int alg=0; alg<3; alg++) {
+                for (int alg=0; alg<NUM_ALGORITHMS; alg++) {
                     if (moveCountAlg[alg] > 0) {
                         double avg = totalTimeAlg[alg] / (double)moveCountAlg[alg];
                         printf("Algorithm %s -> moves: %d, average time: %.4f s\n",
@@ -658,7 +319,28 @@ int main(int argc, char **argv)
                     }
                 }
 
+                if (matchStats.count > 0) {
+                    printf("Threads: %d\n", searchOptions.threads);
+                    statsPrintMatch(stdout, &matchStats);
+                }
+                statsPrintTiming(stdout, &matchStats);
+                if (statsFile != NULL && !statsWriteFile(&matchStats, statsFile, algorithmNames)) {
+                    fprintf(stderr, "Could not write the statistics to %s\n", statsFile);
+                }
 
+                if (bookMoves > 0) {
+                    printf("Book: %d moves\n", bookMoves);
+                }
+
+                if (ponderPredictions > 0) {
+                    printf("Ponder: %d hits of %d predictions, %llu nodes\n", ponderHits, ponderPredictions, ponderNodes);
+                }
+
+                statsFree(&matchStats);
+                ttFree(&transpositionTable);
+                if (bookLoaded) {
+                    bookClose(&openingBook);
+                }
                 close(mySocket);
                 return 0;
         }
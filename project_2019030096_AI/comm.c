@@ -226,22 +226,11 @@ int getName( char textToGet[ MAX_NAME_LENGTH + 1 ], int mySocket )
 /**********************************************************/
 int sendPosition( Position * posToSend, int mySocket )
 {
-	char buffer[ ARRAY_BOARD_SIZE * ARRAY_BOARD_SIZE + 2 + 1 ];
-	int i, j;
+	char buffer[ POSITION_RECORD_SIZE ];
 
-	//board
-	for( i = 0; i < ARRAY_BOARD_SIZE; i++ )
-		for( j = 0; j < ARRAY_BOARD_SIZE; j++ )
-			buffer[ i * ARRAY_BOARD_SIZE + j ] =  posToSend->board[ i ][ j ];
+	positionToRecord( posToSend, buffer );
 
-	//score
-	buffer[ ARRAY_BOARD_SIZE * ARRAY_BOARD_SIZE ] = posToSend->score[ WHITE ];
-	buffer[ ARRAY_BOARD_SIZE * ARRAY_BOARD_SIZE + 1 ] = posToSend->score[ BLACK ];
-
-	//turn
-	buffer[ ARRAY_BOARD_SIZE * ARRAY_BOARD_SIZE + 2 ] = posToSend->turn;
-
-	if( send( mySocket, buffer, ARRAY_BOARD_SIZE * ARRAY_BOARD_SIZE + 2 + 1, 0 ) != ARRAY_BOARD_SIZE * ARRAY_BOARD_SIZE + 2 + 1 )
+	if( send( mySocket, buffer, POSITION_RECORD_SIZE, 0 ) != POSITION_RECORD_SIZE )
 	{
 		printf( "ERROR: Network problem\n" );
 		return -1;
@@ -254,26 +243,19 @@ int sendPosition( Position * posToSend, int mySocket )
 /**********************************************************/
 void getPosition( Position * posToGet, int mySocket )
 {
-	char buffer[ ARRAY_BOARD_SIZE * ARRAY_BOARD_SIZE + 2 + 1 ];
-	int i, j;
+	char buffer[ POSITION_RECORD_SIZE ];
 
-	if( recv( mySocket, buffer, ARRAY_BOARD_SIZE * ARRAY_BOARD_SIZE + 2 + 1, 0 ) != ARRAY_BOARD_SIZE * ARRAY_BOARD_SIZE + 2 + 1 )
+	if( recv( mySocket, buffer, POSITION_RECORD_SIZE, 0 ) != POSITION_RECORD_SIZE )
 	{
 		printf( "ERROR: Network problem\n" );
 		exit( 1 );
 	}
 
-	//board
-	for( i = 0; i < ARRAY_BOARD_SIZE; i++ )
-		for( j = 0; j < ARRAY_BOARD_SIZE; j++ )
-			posToGet->board[ i ][ j ] = buffer[ i * ARRAY_BOARD_SIZE + j ];
-
-	//score
-	posToGet->score[ WHITE ] = buffer[ ARRAY_BOARD_SIZE * ARRAY_BOARD_SIZE ];
-	posToGet->score[ BLACK ] = buffer[ ARRAY_BOARD_SIZE * ARRAY_BOARD_SIZE + 1 ];
-
-	//turn
-	posToGet->turn = buffer[ ARRAY_BOARD_SIZE * ARRAY_BOARD_SIZE + 2 ];
+	if( !positionFromRecord( posToGet, buffer ) )
+	{
+		printf( "ERROR: Invalid position\n" );
+		exit( 1 );
+	}
 }
 
 
@@ -0,0 +1,365 @@
+#include "endgame.h"
+#include <string.h>
+
+
+/**
+ * Final disc difference for the player to move, like evaluatePosition() at the end of the game
+ */
+static int discDifference(const Position *pos)
+{
+    return pos->score[(int) pos->turn] - pos->score[getOtherSide(pos->turn)];
+}
+
+/**
+ * Every SEARCH_CHECK_NODES positions look at the clock and at the stop flag, like negamax()
+ */
+static int mustStop(SearchInfo *info)
+{
+    if ((++info->stats.nodes & (SEARCH_CHECK_NODES - 1)) == 0) {
+        if ((info->deadline > 0 && getTimeSeconds() >= info->deadline)
+            || (info->stop != NULL && __atomic_load_n(info->stop, __ATOMIC_RELAXED))) {
+            info->aborted = TRUE;
+        }
+    }
+    return info->aborted;
+}
+
+/**
+ * Finds the regions of the empty cells (groups of empties next to each other) and sets odd[i] for the
+ * empties in cells[] that lie in a region with an odd number of empties. Playing in an odd region first
+ * tends to leave us the last move of the region, which the opponent cannot answer
+ */
+static void findOddRegions(const Position *pos, const int *cells, int n, int *odd)
+{
+    int region[BOARD_CELLS];
+    int regionSize[BOARD_CELLS];
+    int stack[BOARD_CELLS];
+    int regions = 0;
+
+    BitBoard empty = pos->empty;
+    while (!bbIsEmpty(empty)) {
+        int square = bbPopLowest(&empty);
+        region[getCell(SQUARE_ROW(square), SQUARE_COL(square))] = -1;
+    }
+    for (int i = 0; i < n; i++) {
+        if (region[cells[i]] >= 0) {
+            continue;
+        }
+        // flood the region of this empty through the neighbours that are empty too
+        int top = 0;
+        stack[top++] = cells[i];
+        region[cells[i]] = regions;
+        regionSize[regions] = 0;
+        while (top > 0) {
+            int cell = stack[--top];
+            regionSize[regions]++;
+            for (int d = 0; d < NUM_DIRECTIONS; d++) {
+                int next = getNeighbour(cell, d);
+                if (next >= 0 && pos->board[next] == EMPTY && region[next] < 0) {
+                    region[next] = regions;
+                    stack[top++] = next;
+                }
+            }
+        }
+        regions++;
+    }
+    for (int i = 0; i < n; i++) {
+        odd[i] = regionSize[region[cells[i]]] & 1;
+    }
+}
+
+/**
+ * The last empty cell: whoever can play it plays it, the value needs no move on the board
+ */
+static int solveLast1(SearchInfo *info, int square)
+{
+    Position *pos = &info->pos;
+    int diff = discDifference(pos);
+
+    info->stats.nodes++;
+    COUNT_STAT(&info->stats, leaves);
+    int flips = bbCount(getFlips(pos, square, pos->turn));
+    if (flips > 0) {
+        return diff + 2 * flips + 1;
+    }
+    // we pass, the opponent may still play it
+    flips = bbCount(getFlips(pos, square, getOtherSide(pos->turn)));
+    if (flips > 0) {
+        return diff - 2 * flips - 1;
+    }
+    return diff;
+}
+
+/**
+ * The last 2 .. ENDGAME_LAST_EMPTIES empties, in squares[] in the order to try them.
+ * The moves are found by looking for flips on the empties only, without generating the mobility.
+ * passed is TRUE if the opponent could not move before us, then if we cannot move either the game is over
+ */
+static int solveLastN(SearchInfo *info, const int *squares, int n, int alpha, int beta, int passed)
+{
+    Position *pos = &info->pos;
+
+    if (n == 1) {
+        return solveLast1(info, squares[0]);
+    }
+    if (mustStop(info)) {
+        return 0;
+    }
+
+    int bestVal = -SEARCH_INFINITY;
+    int tried = 0;
+    int rest[ENDGAME_LAST_EMPTIES];
+
+    for (int i = 0; i < n; i++) {
+        GeneratedMove move;
+        move.flips = getFlips(pos, squares[i], pos->turn);
+        if (bbIsEmpty(move.flips)) {
+            continue;
+        }
+        move.move.tile[0] = SQUARE_ROW(squares[i]);
+        move.move.tile[1] = SQUARE_COL(squares[i]);
+        move.move.color   = pos->turn;
+        tried++;
+
+        // the other empties keep their order
+        for (int j = 0, k = 0; j < n; j++) {
+            if (j != i) {
+                rest[k++] = squares[j];
+            }
+        }
+
+        makeGeneratedMove(pos, &move, &info->undo);
+        int value = -solveLastN(info, rest, n - 1, -beta, -alpha, FALSE);
+        unmakeMove(pos, &info->undo);
+
+        if (info->aborted) {
+            return 0;
+        }
+        if (value > bestVal) {
+            bestVal = value;
+        }
+        if (value > alpha) {
+            alpha = value;
+        }
+        if (alpha >= beta) {
+            COUNT_CUTOFF(&info->stats, tried - 1);
+            break;
+        }
+    }
+
+    if (tried > 0) {
+        return bestVal;
+    }
+    // nobody can move, the game is over
+    if (passed) {
+        COUNT_STAT(&info->stats, leaves);
+        return discDifference(pos);
+    }
+    Move passMove;
+    passMove.tile[0] = NULL_MOVE;
+    passMove.color   = pos->turn;
+    makeMove(pos, &passMove, &info->undo);
+    int value = -solveLastN(info, squares, n, -beta, -alpha, TRUE);
+    unmakeMove(pos, &info->undo);
+    return value;
+}
+
+/**
+ * Collects the last empties, the ones in odd regions first, and solves them with solveLastN()
+ */
+static int solveLast(SearchInfo *info, int alpha, int beta)
+{
+    BitBoard empty = info->pos.empty;
+    int squares[ENDGAME_LAST_EMPTIES];
+    int cells[ENDGAME_LAST_EMPTIES];
+    int odd[ENDGAME_LAST_EMPTIES];
+    int n = 0;
+
+    while (!bbIsEmpty(empty) && n < ENDGAME_LAST_EMPTIES) {
+        squares[n] = bbPopLowest(&empty);
+        cells[n] = getCell(SQUARE_ROW(squares[n]), SQUARE_COL(squares[n]));
+        n++;
+    }
+    if (n == 0) {
+        info->stats.nodes++;
+        COUNT_STAT(&info->stats, leaves);
+        return discDifference(&info->pos);
+    }
+
+    if (n > 2) {
+        findOddRegions(&info->pos, cells, n, odd);
+        int ordered[ENDGAME_LAST_EMPTIES];
+        int k = 0;
+        for (int i = 0; i < n; i++) {
+            if (odd[i]) {
+                ordered[k++] = squares[i];
+            }
+        }
+        for (int i = 0; i < n; i++) {
+            if (!odd[i]) {
+                ordered[k++] = squares[i];
+            }
+        }
+        memcpy(squares, ordered, n * sizeof(int));
+    }
+    return solveLastN(info, squares, n, alpha, beta, FALSE);
+}
+
+/**
+ * Orders the moves of an endgame position. With ENDGAME_FASTEST_FIRST empties or more the moves that leave the
+ * opponent the fewest replies go first (it finds the cutoffs with the smallest trees), ties and the positions
+ * with fewer empties go by parity: the moves in odd regions first. Insertion sort, equal keys keep their order
+ */
+static void orderEndgameMoves(Position *pos, MoveList *list, UndoStack *undo, int empties)
+{
+    int keys[MAX_MOVES];
+    int cells[MAX_MOVES];
+    int odd[MAX_MOVES];
+
+    for (int i = 0; i < list->count; i++) {
+        cells[i] = getCell(list->moves[i].move.tile[0], list->moves[i].move.tile[1]);
+    }
+    findOddRegions(pos, cells, list->count, odd);
+
+    for (int i = 0; i < list->count; i++) {
+        // lower keys go first
+        keys[i] = odd[i] ? 0 : 1;
+        if (empties >= ENDGAME_FASTEST_FIRST) {
+            makeGeneratedMove(pos, &list->moves[i], undo);
+            keys[i] += 2 * bbCount(getLegalMoves(pos, pos->turn));
+            unmakeMove(pos, undo);
+        }
+    }
+
+    for (int i = 1; i < list->count; i++) {
+        GeneratedMove move = list->moves[i];
+        int key = keys[i];
+        int j = i - 1;
+        while (j >= 0 && keys[j] > key) {
+            list->moves[j+1] = list->moves[j];
+            keys[j+1] = keys[j];
+            j--;
+        }
+        list->moves[j+1] = move;
+        keys[j+1] = key;
+    }
+}
+
+int endgameSolve(SearchInfo *info, int alpha, int beta)
+{
+    Position *pos = &info->pos;
+    char currentPlayer = pos->turn;
+    int empties = bbCount(pos->empty);
+
+    if (empties <= ENDGAME_LAST_EMPTIES) {
+        return solveLast(info, alpha, beta);
+    }
+    if (mustStop(info)) {
+        return 0;
+    }
+
+    BitBoard mobility[2];
+    TIME_PHASE(&info->stats, SEARCH_PHASE_MOVEGEN, getMobility(pos, mobility));
+
+    // nobody can move, the game is over
+    if (bbIsEmpty(mobility[WHITE]) && bbIsEmpty(mobility[BLACK])) {
+        COUNT_STAT(&info->stats, leaves);
+        int value;
+        TIME_PHASE(&info->stats, SEARCH_PHASE_EVAL, value = discDifference(pos));
+        return value;
+    }
+
+    // we cannot move but the other player can, pass the turn
+    if (bbIsEmpty(mobility[(int) currentPlayer])) {
+        Move passMove;
+        passMove.tile[0] = NULL_MOVE;
+        passMove.color   = currentPlayer;
+        makeMove(pos, &passMove, &info->undo);
+        int value = -endgameSolve(info, -beta, -alpha);
+        unmakeMove(pos, &info->undo);
+        return value;
+    }
+
+    MoveList list;
+    TIME_PHASE(&info->stats, SEARCH_PHASE_MOVEGEN, generateMovesFromSet(pos, currentPlayer, mobility[(int) currentPlayer], &list));
+    TIME_PHASE(&info->stats, SEARCH_PHASE_ORDERING, orderEndgameMoves(pos, &list, &info->undo, empties));
+
+    int bestVal = -SEARCH_INFINITY;
+    for (int i = 0; i < list.count; i++) {
+        makeGeneratedMove(pos, &list.moves[i], &info->undo);
+        int value = -endgameSolve(info, -beta, -alpha);
+        unmakeMove(pos, &info->undo);
+
+        if (info->aborted) {
+            return 0;
+        }
+        if (value > bestVal) {
+            bestVal = value;
+        }
+        if (value > alpha) {
+            alpha = value;
+        }
+        if (alpha >= beta) {
+            COUNT_CUTOFF(&info->stats, i);
+            break;
+        }
+    }
+    return bestVal;
+}
+
+Move endgameSearch(Position *rootPos, const SearchOptions *options, int mode, double deadline, SearchReport *report, int *solved)
+{
+    double start = getTimeSeconds();
+    SearchInfo info;
+
+    memcpy(&info.pos, rootPos, sizeof(Position));
+    initUndoStack(&info.undo);
+    memset(&info.stats, 0, sizeof(SearchStats));
+    info.deadline = deadline;
+    info.aborted = FALSE;
+    info.reachedDepthLimit = FALSE;
+    info.tt = NULL;
+    info.stop = options->stop;
+
+    Move bestMove;
+    bestMove.tile[0] = NULL_MOVE;
+    bestMove.color   = rootPos->turn;
+
+    MoveList list;
+    generateMoves(&info.pos, info.pos.turn, &list);
+    orderEndgameMoves(&info.pos, &list, &info.undo, bbCount(info.pos.empty));
+
+    // the win/loss/draw search only asks if a move wins, once one does the others do not matter
+    int alpha = mode == ENDGAME_WIN_LOSS_DRAW ? -1 : -SEARCH_INFINITY;
+    int beta = mode == ENDGAME_WIN_LOSS_DRAW ? 1 : SEARCH_INFINITY;
+    int bestVal = -SEARCH_INFINITY;
+    for (int i = 0; i < list.count; i++) {
+        makeGeneratedMove(&info.pos, &list.moves[i], &info.undo);
+        int value = -endgameSolve(&info, -beta, -alpha);
+        unmakeMove(&info.pos, &info.undo);
+
+        if (info.aborted) {
+            break;
+        }
+        // only a better move replaces the best one, so ties keep the first move in the order
+        if (value > bestVal) {
+            bestVal = value;
+            bestMove = list.moves[i].move;
+        }
+        if (value > alpha) {
+            alpha = value;
+        }
+        if (alpha >= beta) {
+            break;
+        }
+    }
+
+    *solved = !info.aborted && list.count > 0;
+    if (report != NULL) {
+        report->depth = bbCount(rootPos->empty);
+        report->score = list.count > 0 ? bestVal : 0;
+        report->stats = info.stats;
+        report->seconds = getTimeSeconds() - start;
+    }
+    return bestMove;
+}
@@ -0,0 +1,35 @@
+#ifndef _ENDGAME_H
+#define _ENDGAME_H
+
+#include "search.h"
+
+/**********************************************************/
+
+/* What endgameSearch() proves: the final disc difference or only if the game is won, lost or drawn.
+ * WIN_LOSS_DRAW is the same search with the window (-1, 1), it cuts far more */
+#define ENDGAME_EXACT 0
+#define ENDGAME_WIN_LOSS_DRAW 1
+
+/* Default number of empty cells from which the client solves the game exactly (-e), the
+ * win/loss/draw search starts ENDGAME_WLD_EXTRA empties earlier */
+#define ENDGAME_DEFAULT_EMPTIES 12
+#define ENDGAME_WLD_EXTRA 2
+
+/* With this many empties or more the moves are ordered fastest-first (fewest replies of the opponent),
+ * below it only by parity, which costs nothing to compute */
+#define ENDGAME_FASTEST_FIRST 7
+
+/* With this many empties or less the solver walks the empty cells directly, no move lists */
+#define ENDGAME_LAST_EMPTIES 4
+
+/**********************************************************/
+
+int endgameSolve(SearchInfo *info, int alpha, int beta);
+// value of info->pos for the player to move at the end of the game (final disc difference) with alpha-beta in (alpha, beta)
+// like negamax() it stops when info->deadline passes or info->stop is set (then info->aborted is set and the value is useless)
+
+Move endgameSearch(Position *rootPos, const SearchOptions *options, int mode, double deadline, SearchReport *report, int *solved);
+// best move of rootPos proven to the end of the game (mode is ENDGAME_EXACT or ENDGAME_WIN_LOSS_DRAW)
+// deadline is a getTimeSeconds() time or 0 for no limit, *solved is FALSE if the search stopped before the proof
+
+#endif
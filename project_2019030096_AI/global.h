@@ -28,6 +28,9 @@
 #define HEX_BOARD_RADIUS 7
 #define ARRAY_BOARD_SIZE (HEX_BOARD_RADIUS * 2 + 1)
 
+/* Number of real cells of the hexagon (169), the board array keeps only these */
+#define BOARD_CELLS (3 * HEX_BOARD_RADIUS * (HEX_BOARD_RADIUS + 1) + 1)
+
 /* used to describe a null move (the only legal "move" when no move is available) */
 #define NULL_MOVE -50
 
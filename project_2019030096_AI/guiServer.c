@@ -196,7 +196,7 @@ void printToGui( void )
 	for( i = 0; i < ARRAY_BOARD_SIZE; i++ )
 	{
 		for( j = 0; j < ARRAY_BOARD_SIZE; j++ )
-			switch( gamePosition.board[ i ][ j ] )
+			switch( getTile( &gamePosition, i, j ) )
 			{
 				case WHITE:
 					gtk_image_set_from_file( GTK_IMAGE( imageBoard[ i ][ j ] ), "images/simple/white.jpg" );
@@ -252,7 +252,7 @@ void playRandom( void )
 			i = rand() % ARRAY_BOARD_SIZE;
 			j = rand() % ARRAY_BOARD_SIZE;
 
-			if( gamePosition.board[ i ][ j ] == EMPTY )
+			if( getTile( &gamePosition, i, j ) == EMPTY )
 			{
 				tempMove.tile[ 0 ] = i;
 				tempMove.tile[ 1 ] = j;
@@ -376,6 +376,7 @@ void messageFromSocket( void )
 {
 	PlayerStruct * playingPlayer = NULL;
 	PlayerStruct * waitingPlayer = NULL;
+	BitBoard legalMoves;
 	int i;
 
 	if( gamePosition.turn == WHITE )
@@ -408,7 +409,9 @@ void messageFromSocket( void )
 	tempMove.color = playingPlayer->color;
 
 
-	if( !canMove( &gamePosition, playingPlayer->color ) )	//if that player cannot move, the only legal move is null
+	legalMoves = getLegalMoves( &gamePosition, playingPlayer->color );
+
+	if( bbIsEmpty( legalMoves ) )	//if that player cannot move, the only legal move is null
 	{
 		if( tempMove.tile[ 0 ] != NULL_MOVE )	//technical loss
 		{
@@ -420,7 +423,7 @@ void messageFromSocket( void )
 	}
 	else
 	{
-		if( !isLegalMove( &gamePosition, &tempMove ) )
+		if( !isMoveInSet( legalMoves, &tempMove ) )
 		{
 			//technical loss
 			sprintf( tempMessage, "Player: %s tried an illegal move and lost the game!\nIllegal move:", playingPlayer->name );
@@ -497,16 +500,16 @@ void highlightPossibleMoves( char color )
 {
 
 	unsigned short int i,j;
+	BitBoard legalMoves = getLegalMoves( &gamePosition, color );
 
-	for(i=0 ; i <ARRAY_BOARD_SIZE ; i++)
-		for (j=0 ; j <ARRAY_BOARD_SIZE ; j++)
-		{
-			if (isLegal(&gamePosition, i, j, color))
-			{
-				gtk_image_set_from_file(GTK_IMAGE(imageBoard[ i ][ j ]),"images/simple/possibleMove.jpg");
-				GuiBoard[ i ][ j ].state = ST_EMPTY_POSSIBLE_MOVE_HIGHTLIGHT;
-			}
-		}
+	while( !bbIsEmpty( legalMoves ) )
+	{
+		int sq = bbPopLowest( &legalMoves );
+		i = SQUARE_ROW( sq );
+		j = SQUARE_COL( sq );
+		gtk_image_set_from_file(GTK_IMAGE(imageBoard[ i ][ j ]),"images/simple/possibleMove.jpg");
+		GuiBoard[ i ][ j ].state = ST_EMPTY_POSSIBLE_MOVE_HIGHTLIGHT;
+	}
 }
 
 /**********************************************************/
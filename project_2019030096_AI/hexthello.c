@@ -0,0 +1,112 @@
+#include "hexthello.h"
+#include "endgame.h"
+#include <stdlib.h>
+#include <string.h>
+
+
+struct HexEngine {
+    TranspositionTable tt;
+    int hasTable;
+};
+
+HexEngine *hexEngineCreate(int hashSizeMB)
+{
+    HexEngine *engine = (HexEngine *) calloc(1, sizeof(HexEngine));
+
+    if (engine == NULL) {
+        return NULL;
+    }
+    if (hashSizeMB > 0) {
+        if (!ttInit(&engine->tt, hashSizeMB)) {
+            free(engine);
+            return NULL;
+        }
+        engine->hasTable = TRUE;
+    }
+    return engine;
+}
+
+void hexEngineDestroy(HexEngine *engine)
+{
+    if (engine == NULL) {
+        return;
+    }
+    if (engine->hasTable) {
+        ttFree(&engine->tt);
+    }
+    free(engine);
+}
+
+void hexEngineClear(HexEngine *engine)
+{
+    if (engine->hasTable) {
+        ttClear(&engine->tt);
+    }
+}
+
+void hexDefaultLimits(HexLimits *limits)
+{
+    limits->algorithm = ALG_PVS;
+    limits->maxDepth = ΜΑΧ_DEPTH;
+    limits->timeLimitMs = 0;
+    limits->threads = 1;
+    limits->endgameEmpties = ENDGAME_DEFAULT_EMPTIES;
+    limits->stop = NULL;
+}
+
+/**
+ * Copies pos to rootPos with side to move. The hash covers the turn, so it is computed again when the turn changes
+ */
+static int setUpRoot(Position *rootPos, const Position *pos, char side)
+{
+    if (side != WHITE && side != BLACK) {
+        return FALSE;
+    }
+    memcpy(rootPos, pos, sizeof(Position));
+    if (rootPos->turn != side) {
+        rootPos->turn = side;
+        rootPos->hash = computeHash(rootPos);
+    }
+    return TRUE;
+}
+
+int hexSearch(HexEngine *engine, const Position *pos, char side, const HexLimits *limits, HexResult *result)
+{
+    Position rootPos;
+    SearchReport report;
+
+    memset(result, 0, sizeof(HexResult));
+    result->move.tile[0] = NULL_MOVE;
+    result->move.color = side;
+
+    if (engine == NULL || limits->algorithm < 0 || limits->algorithm >= NUM_ALGORITHMS
+        || limits->maxDepth < 1 || limits->maxDepth > MAX_SEARCH_DEPTH || !setUpRoot(&rootPos, pos, side)) {
+        return FALSE;
+    }
+
+    SearchOptions options;
+    options.maxDepth = limits->maxDepth;
+    options.timeLimitMs = limits->timeLimitMs > 0 ? limits->timeLimitMs : 0;
+    options.threads = limits->threads > 1 ? limits->threads : 1;
+    options.tt = engine->hasTable ? &engine->tt : NULL;
+    options.stop = limits->stop;
+    options.endgameEmpties = limits->endgameEmpties > 0 ? limits->endgameEmpties : 0;
+
+    memset(&report, 0, sizeof(SearchReport));
+    result->move = findBestMove(&rootPos, side, limits->algorithm, &options, &report);
+    result->score = report.score;
+    result->depth = report.depth;
+    result->stats = report.stats;
+    result->seconds = report.seconds;
+    return result->move.tile[0] != NULL_MOVE;
+}
+
+int hexAnalyse(HexEngine *engine, const Position *pos, char side, int depth, int timeLimitMs, int lineCount, AnalysisLine *lines, SearchReport *report)
+{
+    Position rootPos;
+
+    if (engine == NULL || depth < 1 || depth > MAX_SEARCH_DEPTH || !setUpRoot(&rootPos, pos, side)) {
+        return -1;
+    }
+    return analysePosition(&rootPos, depth, timeLimitMs > 0 ? timeLimitMs : 0, lineCount, engine->hasTable ? &engine->tt : NULL, lines, report);
+}
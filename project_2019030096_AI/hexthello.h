@@ -0,0 +1,61 @@
+#ifndef _HEXTHELLO_H
+#define _HEXTHELLO_H
+
+#include "search.h"
+#include "analysis.h"
+
+/**********************************************************/
+
+/**
+ *  libhexthello: the board and the searches of the client as a library (make libhexthello.a, include this header).
+ *
+ *  Everything a search works on belongs to an engine or to the call, the board tables are filled once by the first
+ *  thread that needs them, so any number of searches can run at the same time in one process, one per engine.
+ *  An engine is not locked: two threads must not search with the same engine at once, give each thread its own.
+ *  The positions are the ones of board.h, see positionFromText() to make one from text
+ */
+
+/* An engine: the transposition table its searches keep between the moves of a game */
+typedef struct HexEngine HexEngine;
+
+/* What hexSearch() is allowed to do, see SearchOptions for the meaning of each limit */
+typedef struct {
+    int algorithm;                 // ALG_SIMPLE_MINIMAX .. ALG_PVS
+    int maxDepth;                  // deepest iteration (1 .. MAX_SEARCH_DEPTH)
+    int timeLimitMs;               // 0 for no limit
+    int threads;                   // threads of this one search
+    int endgameEmpties;            // empties left when the game is solved exactly, 0 never
+    const int *stop;               // set by another thread to end the search at once, can be NULL
+} HexLimits;
+
+/* What hexSearch() found */
+typedef struct {
+    Move move;                     // tile[0] is NULL_MOVE if the side cannot play
+    int score;                     // value of the move for the side, see SearchReport
+    int depth;
+    SearchStats stats;
+    double seconds;
+} HexResult;
+
+/**********************************************************/
+
+HexEngine *hexEngineCreate(int hashSizeMB);
+// a new engine with a transposition table of hashSizeMB MB, 0 for none. NULL if the memory cannot be allocated
+
+void hexEngineDestroy(HexEngine *engine);
+// frees the engine and its table, NULL is ignored
+
+void hexEngineClear(HexEngine *engine);
+// forgets every position searched before, for a new game
+
+void hexDefaultLimits(HexLimits *limits);
+// PVS to the default depth of the client, no time limit, one thread and the endgame solver of the client
+
+int hexSearch(HexEngine *engine, const Position *pos, char side, const HexLimits *limits, HexResult *result);
+// searches the best move of side (WHITE or BLACK) in pos, whatever pos->turn is. pos is not changed.
+// Returns TRUE if side has a move, FALSE if it has to pass or the engine, side or limits are not valid
+
+int hexAnalyse(HexEngine *engine, const Position *pos, char side, int depth, int timeLimitMs, int lineCount, AnalysisLine *lines, SearchReport *report);
+// the lineCount best moves of side in pos, see analysePosition(). -1 if the side or the depth are not valid
+
+#endif
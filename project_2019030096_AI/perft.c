@@ -0,0 +1,333 @@
+#include "global.h"
+#include "board.h"
+#include "move.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+#include <unistd.h>
+
+
+/* Perft: counts the leaves of the full move tree of a position to a fixed depth.
+ *
+ * Every ply is one move of the side to move. A side that cannot move plays the null move,
+ * which is a ply like any other. A position where neither side can move is a leaf, even if
+ * it is above the requested depth.
+ *
+ * The counts only depend on the rules, so any change of the board kernel must keep them.
+ * Two kernels are walked: the bitboard one used by the clients (generateMoves / makeGeneratedMove)
+ * and the mailbox one (doAllDirections over every cell), which is kept as the reference. */
+
+#define KERNEL_BITBOARD 0
+#define KERNEL_MAILBOX 1
+
+#define MAX_LINE 1024
+
+static const char * kernelName[ 2 ] = { "bitboard", "mailbox" };
+
+static UndoStack undo;
+
+
+/**********************************************************/
+static double now( void )
+{
+	struct timespec ts;
+
+	clock_gettime( CLOCK_MONOTONIC, &ts );
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**********************************************************/
+static unsigned long long perftBitBoard( Position * pos, int depth )
+{
+	BitBoard legalMoves;
+	MoveList list;
+	Move passMove;
+	unsigned long long nodes = 0;
+	int i;
+
+	if( depth == 0 )
+		return 1;
+
+	legalMoves = getLegalMoves( pos, pos->turn );
+
+	if( bbIsEmpty( legalMoves ) )
+	{
+		if( !canMove( pos, getOtherSide( pos->turn ) ) )
+			return 1;		//game over
+
+		passMove.tile[ 0 ] = NULL_MOVE;
+		passMove.color = pos->turn;
+		makeMove( pos, &passMove, &undo );
+		nodes = perftBitBoard( pos, depth - 1 );
+		unmakeMove( pos, &undo );
+		return nodes;
+	}
+
+	generateMovesFromSet( pos, pos->turn, legalMoves, &list );
+
+	if( depth == 1 )
+		return list.count;		//bulk count, the children are all leaves
+
+	for( i = 0; i < list.count; i++ )
+	{
+		makeGeneratedMove( pos, &list.moves[ i ], &undo );
+		nodes += perftBitBoard( pos, depth - 1 );
+		unmakeMove( pos, &undo );
+	}
+
+	return nodes;
+}
+
+/**********************************************************/
+static int mailboxCanMove( Position * pos, char color )
+{
+	Move move;
+	int i, j;
+
+	move.color = color;
+	for( i = 0; i < ARRAY_BOARD_SIZE; i++ )
+		for( j = 0; j < ARRAY_BOARD_SIZE; j++ )
+		{
+			if( getTile( pos, i, j ) != EMPTY )
+				continue;
+			move.tile[ 0 ] = i;
+			move.tile[ 1 ] = j;
+			if( doAllDirections( pos, &move, FALSE ) )
+				return TRUE;
+		}
+
+	return FALSE;
+}
+
+/**********************************************************/
+static unsigned long long perftMailbox( Position * pos, int depth )
+{
+	Position child;
+	Move move;
+	unsigned long long nodes = 0;
+	int i, j;
+
+	if( depth == 0 )
+		return 1;
+
+	if( !mailboxCanMove( pos, pos->turn ) )
+	{
+		if( !mailboxCanMove( pos, getOtherSide( pos->turn ) ) )
+			return 1;		//game over
+
+		child = *pos;
+		move.tile[ 0 ] = NULL_MOVE;
+		move.color = pos->turn;
+		doAllDirections( &child, &move, TRUE );
+		return perftMailbox( &child, depth - 1 );
+	}
+
+	move.color = pos->turn;
+	for( i = 0; i < ARRAY_BOARD_SIZE; i++ )
+		for( j = 0; j < ARRAY_BOARD_SIZE; j++ )
+		{
+			if( getTile( pos, i, j ) != EMPTY )
+				continue;
+			move.tile[ 0 ] = i;
+			move.tile[ 1 ] = j;
+			if( !doAllDirections( pos, &move, FALSE ) )
+				continue;
+
+			child = *pos;
+			doAllDirections( &child, &move, TRUE );
+			nodes += perftMailbox( &child, depth - 1 );
+		}
+
+	return nodes;
+}
+
+/**********************************************************/
+static unsigned long long runPerft( Position * pos, int depth, int kernel )
+{
+	Position copy = *pos;
+	unsigned long long nodes;
+
+	initUndoStack( &undo );
+
+	if( kernel == KERNEL_MAILBOX )
+		nodes = perftMailbox( &copy, depth );
+	else
+		nodes = perftBitBoard( &copy, depth );
+
+	if( memcmp( &copy, pos, sizeof( Position ) ) != 0 )
+		printf( "ERROR: the position was not restored after the perft\n" );
+
+	return nodes;
+}
+
+/**********************************************************/
+/* Runs the perft of one position with each kernel asked for and prints one line per depth.
+ * Returns the number of counts that did not match (between the kernels or against expected) */
+static int perftPosition( const char * name, Position * pos, int maxDepth, int kernels, long long expected )
+{
+	unsigned long long nodes[ 2 ];
+	double seconds;
+	int depth, k, errors = 0;
+
+	for( depth = ( expected >= 0 ? maxDepth : 1 ); depth <= maxDepth; depth++ )
+	{
+		printf( "%-12s depth %2d", name, depth );
+
+		for( k = KERNEL_BITBOARD; k <= KERNEL_MAILBOX; k++ )
+		{
+			if( !( kernels & ( 1 << k ) ) )
+				continue;
+
+			seconds = now();
+			nodes[ k ] = runPerft( pos, depth, k );
+			seconds = now() - seconds;
+
+			printf( "   %s %12llu nodes %8.3f s %12.0f nps", kernelName[ k ], nodes[ k ], seconds, seconds > 0 ? nodes[ k ] / seconds : 0 );
+		}
+
+		if( kernels == ( ( 1 << KERNEL_BITBOARD ) | ( 1 << KERNEL_MAILBOX ) ) && nodes[ KERNEL_BITBOARD ] != nodes[ KERNEL_MAILBOX ] )
+		{
+			printf( "   MISMATCH" );
+			errors++;
+		}
+
+		k = ( kernels & ( 1 << KERNEL_BITBOARD ) ) ? KERNEL_BITBOARD : KERNEL_MAILBOX;
+		if( expected >= 0 && nodes[ k ] != (unsigned long long) expected )
+		{
+			printf( "   EXPECTED %lld", expected );
+			errors++;
+		}
+
+		printf( "\n" );
+		fflush( stdout );
+	}
+
+	return errors;
+}
+
+/**********************************************************/
+/* Writes pos in binary form (the one of the network) and reads it back, the position must come back the same.
+ * Returns 1 if it does not */
+static int checkRecord( const char * name, Position * pos )
+{
+	char record[ POSITION_RECORD_SIZE ];
+	Position back;
+
+	positionToRecord( pos, record );
+	if( positionFromRecord( &back, record ) && memcmp( back.board, pos->board, BOARD_CELLS ) == 0 && back.turn == pos->turn
+			&& back.score[ WHITE ] == pos->score[ WHITE ] && back.score[ BLACK ] == pos->score[ BLACK ] && back.hash == pos->hash )
+		return 0;
+
+	printf( "%-12s RECORD MISMATCH\n", name );
+	return 1;
+}
+
+/**********************************************************/
+/* Each line of the file is a position in text form (see positionFromText()), optionally
+ * followed by a depth and the expected node count. Empty lines and lines starting with # are skipped.
+ * Every position is also checked in binary form (see checkRecord()) */
+static int perftFile( const char * fileName, int maxDepth, int kernels )
+{
+	FILE * file;
+	char line[ MAX_LINE ];
+	char name[ 32 ];
+	Position pos;
+	int used, depth, lineNumber = 0, errors = 0;
+	long long expected;
+
+	if( ( file = fopen( fileName, "r" ) ) == NULL )
+	{
+		printf( "Could not open %s\n", fileName );
+		return 1;
+	}
+
+	while( fgets( line, MAX_LINE, file ) != NULL )
+	{
+		lineNumber++;
+
+		if( line[ 0 ] == '#' || line[ strspn( line, " \t\r\n" ) ] == '\0' )
+			continue;
+
+		if( ( used = positionFromText( &pos, line ) ) == 0 )
+		{
+			printf( "%s:%d: not a valid position\n", fileName, lineNumber );
+			errors++;
+			continue;
+		}
+
+		snprintf( name, sizeof( name ), "line %d", lineNumber );
+		errors += checkRecord( name, &pos );
+
+		if( sscanf( line + used, "%d %lld", &depth, &expected ) == 2 )
+			errors += perftPosition( name, &pos, depth, kernels, expected );
+		else
+			errors += perftPosition( name, &pos, maxDepth, kernels, -1 );
+	}
+
+	fclose( file );
+	return errors;
+}
+
+/**********************************************************/
+int main( int argc, char **argv )
+{
+	int c;
+	int maxDepth = 5;
+	int kernels = 1 << KERNEL_BITBOARD;
+	char * fileName = NULL;
+	Position pos;
+	int errors;
+
+	opterr = 0;
+
+	while( ( c = getopt( argc, argv, "d:f:mch" ) ) != -1 )
+		switch( c )
+		{
+			case 'h':
+				printf( "[-d depth] [-f positions_file] [-m (mailbox kernel)] [-c (cross-check bitboard and mailbox kernels)]\n" );
+				return 0;
+			case 'd':
+				maxDepth = atoi( optarg );
+				break;
+			case 'f':
+				fileName = optarg;
+				break;
+			case 'm':
+				kernels = 1 << KERNEL_MAILBOX;
+				break;
+			case 'c':
+				kernels = ( 1 << KERNEL_BITBOARD ) | ( 1 << KERNEL_MAILBOX );
+				break;
+			case '?':
+				if( optopt == 'd' || optopt == 'f' )
+					printf( "Option -%c requires an argument.\n", ( char ) optopt );
+				else if( isprint( optopt ) )
+					printf( "Unknown option -%c\n", ( char ) optopt );
+				else
+					printf( "Unknown option character -%c\n", ( char ) optopt );
+				return 1;
+			default:
+			return 1;
+		}
+
+	if( maxDepth < 1 || maxDepth >= MAX_UNDO )
+	{
+		printf( "Depth must be between 1 and %d\n", MAX_UNDO - 1 );
+		return 1;
+	}
+
+	if( fileName != NULL )
+		errors = perftFile( fileName, maxDepth, kernels );
+	else
+	{
+		initPosition( &pos );
+		errors = perftPosition( "start", &pos, maxDepth, kernels, -1 );
+	}
+
+	if( errors )
+		printf( "%d count(s) did not match\n", errors );
+
+	return errors ? 1 : 0;
+}
@@ -0,0 +1,97 @@
+#include "ponder.h"
+#include <string.h>
+
+
+int canPonder(int alg)
+{
+    return alg == ALG_NEGAMAX || alg == ALG_PVS;
+}
+
+static int sameMove(const Move *a, const Move *b)
+{
+    if (a->tile[0] == NULL_MOVE || b->tile[0] == NULL_MOVE) {
+        return a->tile[0] == b->tile[0];
+    }
+    return a->tile[0] == b->tile[0] && a->tile[1] == b->tile[1];
+}
+
+/**
+ * The reply we expect from the player to move in pos: the best move the table keeps for pos (our last
+ * search looked at it right after our move), else the move that flips the most pieces
+ */
+static Move predictReply(Position *pos, TranspositionTable *tt)
+{
+    Move reply;
+    reply.tile[0] = NULL_MOVE;
+    reply.color   = pos->turn;
+
+    MoveList list;
+    generateMoves(pos, pos->turn, &list);
+    if (list.count == 0) {
+        return reply;
+    }
+
+    TTData entry;
+    if (tt != NULL && ttProbe(tt, pos->hash, &entry) && entry.bestMove.tile[0] != NULL_MOVE) {
+        entry.bestMove.color = pos->turn;
+        if (findGeneratedMove(&list, &entry.bestMove) != NULL) {
+            return entry.bestMove;
+        }
+    }
+
+    orderMovesByFlips(&list);
+    return list.moves[0].move;
+}
+
+static void *runPonder(void *arg)
+{
+    Ponder *ponder = (Ponder *) arg;
+    findBestMove(&ponder->pos, ponder->pos.turn, ponder->alg, &ponder->options, &ponder->report);
+    return NULL;
+}
+
+/**
+ * The ponder search is a search of its own: findBestMove() starts a new generation of the table for it, and our real
+ * search starts the next one. So by then the ponder entries are one search old, hit or miss. ttProbe() still finds
+ * them, but ttStore() counts them as empty and replaces them first, like the entries of our previous move
+ */
+int startPondering(Ponder *ponder, const Position *pos, int alg, const SearchOptions *options)
+{
+    ponder->running = FALSE;
+    memcpy(&ponder->pos, pos, sizeof(Position));
+
+    // nobody can move, the game is over
+    if (!canMove(&ponder->pos, WHITE) && !canMove(&ponder->pos, BLACK)) {
+        return FALSE;
+    }
+
+    ponder->predicted = predictReply(&ponder->pos, options->tt);
+    doMove(&ponder->pos, &ponder->predicted);
+
+    // the search runs until we stop it or it reaches the depth of the client
+    ponder->options = *options;
+    ponder->options.timeLimitMs = 0;
+    ponder->options.stop = &ponder->stop;
+    ponder->alg = alg;
+    ponder->stop = FALSE;
+    memset(&ponder->report, 0, sizeof(SearchReport));
+
+    if (pthread_create(&ponder->thread, NULL, runPonder, ponder) != 0) {
+        return FALSE;
+    }
+    ponder->running = TRUE;
+    return TRUE;
+}
+
+int stopPondering(Ponder *ponder, const Move *reply)
+{
+    if (!ponder->running) {
+        return FALSE;
+    }
+
+    __atomic_store_n(&ponder->stop, TRUE, __ATOMIC_RELAXED);
+    pthread_join(ponder->thread, NULL);
+    ponder->running = FALSE;
+
+    return reply != NULL && sameMove(reply, &ponder->predicted);
+}
@@ -0,0 +1,40 @@
+#ifndef _PONDER_H
+#define _PONDER_H
+
+#include "search.h"
+#include <pthread.h>
+
+/**********************************************************/
+
+/**
+ *  A search on the opponent's time. After we play, the reply we expect from the opponent is played on a copy
+ *  of the position and our next move is searched in a background thread while the client waits for the server.
+ *  The search fills the transposition table, so when the opponent plays the expected move our real search
+ *  finds the iterations the ponder search finished already in the table (a ponder hit). Otherwise its entries
+ *  only help where the two searches meet the same positions and are replaced first by the next search
+ */
+typedef struct {
+    Position pos;                  // position after the expected reply, our turn (or the opponent's again if we must pass)
+    Move predicted;                // the reply we expect, a NULL move if the opponent has to pass
+    SearchOptions options;         // the options of the client without a time limit, stop points to our flag
+    int alg;
+    int stop;                      // set to end the background search
+    int running;                   // the thread was started and not joined yet
+    SearchReport report;           // what the last ponder search did (valid after stopPondering())
+    pthread_t thread;
+} Ponder;
+
+/**********************************************************/
+
+int canPonder(int alg);
+// TRUE if the algorithm keeps its results in the transposition table, so a ponder search can help it
+
+int startPondering(Ponder *ponder, const Position *pos, int alg, const SearchOptions *options);
+// predicts the reply of the opponent (the player to move in pos) and starts searching the position after it
+// returns FALSE if the game is over or the thread could not be started
+
+int stopPondering(Ponder *ponder, const Move *reply);
+// stops the background search (if one runs) and waits for it
+// returns TRUE if reply is the move it predicted, reply can be NULL when the move is not known
+
+#endif
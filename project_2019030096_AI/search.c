@@ -0,0 +1,1209 @@
+#include "search.h"
+#include "ybwc.h"
+#include "endgame.h"
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <math.h>
+#include <time.h>
+#include <pthread.h>
+
+
+treeNode* createTreeNode(const Position *p, const GeneratedMove *move)
+
+/**
+ * Create a new node given the move that led to it (the position is only used for the root's color)
+ */
+{	
+	
+	// create new node
+	treeNode* node = (treeNode*) malloc(sizeof(treeNode));
+
+	// check if this node is a root
+    if (move != NULL) {
+		// if not save the move
+        node->lastMove = *move;
+    } else {
+		// if yes set last move to NULL
+        node->lastMove.move.tile[0] = NULL_MOVE;
+        node->lastMove.move.color   = p->turn; 
+        node->lastMove.flips = bbZero();
+    }
+
+	// set vals to zero
+    node->valuation = 0;
+    node->childCount = 0;
+    for (int i = 0; i < MAX_CHILDREN; i++)
+        node->children[i] = NULL;
+
+    return node;
+}
+/**
+ * Free the tree
+ */
+void freeTree(treeNode *node)
+{
+    if (!node) return;
+    for (int i = 0; i < node->childCount; i++) {
+        if (node->children[i]) {
+            freeTree(node->children[i]);
+            node->children[i] = NULL;
+        }
+    }
+    free(node);
+}
+
+/**
+ * Check if a given position is terminal by checking if there are any legal moves remaining
+ * Basicaly check if  can move is false  for both players collors
+ */
+int isTerminalPosition(const Position *position)
+{
+    BitBoard mobility[2];
+    getMobility((Position*)position, mobility);
+    if (bbIsEmpty(mobility[WHITE]) && bbIsEmpty(mobility[BLACK])) {
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * Simple evaluation of position as given in exercise's decsription
+ * we evaluate a certain position by the difference of our and opponet's score
+ */
+int evaluatePosition(const Position *position, char ourColor)
+{	
+	// get my score
+    int myScore  = position->score[(int) ourColor];
+	// get opponets score
+    int oppScore = position->score[(int) getOtherSide(ourColor)];
+    return (myScore - oppScore);
+}
+
+
+/**
+ * Generates every legal move of the current player (legalMoves) together with the pieces it flips
+ * For every legal move we create a new node  representing the new state
+ * The new node only keeps the move and its flips, the search plays it on the shared position when it visits the node
+ * without scanning the board again
+ * 
+ * Returns the number of children created for the given node
+ */
+int expandNode(treeNode *node, Position *pos, char currentColor, BitBoard legalMoves)
+{
+	// save the number of childen created
+    int count = 0;
+    // get the flips of every legal move of the current player (the set comes from the caller)
+    MoveList list;
+    generateMovesFromSet(pos, currentColor, legalMoves, &list);
+
+    for (int i = 0; i < list.count; i++) {
+        // create new child (new node state)
+        treeNode *child = createTreeNode(pos, &list.moves[i]);
+
+        // connect the new child to the current node
+        node->children[node->childCount++] = child;
+
+		// keep track of the children number created
+        count++;
+    }
+    return count;
+}
+
+
+/**
+ * Simple Minimax algo
+ * The first call is always the maximizer 
+ */
+int simpleMinimax(treeNode *node, Position *pos, UndoStack *undo, SearchStats *stats, int depth, char maximizingColor)
+{
+	// define curent player
+    char currentPlayer = pos->turn;
+    stats->nodes++;
+
+    // leaf of the search, no need to look at the moves
+    if (depth == 0) {
+        COUNT_STAT(stats, leaves);
+        TIME_PHASE(stats, SEARCH_PHASE_EVAL, node->valuation = evaluatePosition(pos, maximizingColor));
+        return node->valuation;
+    }
+
+    // get the legal moves of both players in one pass
+    // they decide if the position is terminal, if we have to pass and which children we create
+    BitBoard mobility[2];
+    TIME_PHASE(stats, SEARCH_PHASE_MOVEGEN, getMobility(pos, mobility));
+
+    // check if a position is terminal 
+	// if yes return its value
+    if (bbIsEmpty(mobility[WHITE]) && bbIsEmpty(mobility[BLACK])) {
+        COUNT_STAT(stats, leaves);
+        TIME_PHASE(stats, SEARCH_PHASE_EVAL, node->valuation = evaluatePosition(pos, maximizingColor));
+        return node->valuation;
+    }
+
+	// expand the nodes childrens
+    int childCount;
+    TIME_PHASE(stats, SEARCH_PHASE_MOVEGEN, childCount = expandNode(node, pos, currentPlayer, mobility[(int) currentPlayer]));
+
+	// check if there are no available moves (children)
+    if (childCount == 0) {  
+		// the position is not terminal, so the other player has moves 
+		// we have to simulate the other players turn since we lose ours
+		// play a null move switching the turn to the other player
+        Move passMove;
+        passMove.tile[0] = NULL_MOVE;
+        passMove.color   = currentPlayer;
+        makeMove(pos, &passMove, undo);
+        
+        // create a temporary node to call a new minimax for our next turn
+        treeNode *tempNode = createTreeNode(pos, NULL);
+
+		// call minimax to find oure next turns value
+		node->valuation = simpleMinimax(tempNode, pos, undo, stats, depth-1, maximizingColor);
+
+		freeTree(tempNode);
+        unmakeMove(pos, undo);
+		
+        return node-> valuation;
+    }
+
+	// case of max player
+    if (currentPlayer == maximizingColor) {
+        
+		// set best val to -oo
+        int bestVal = INT_MIN;
+		// call Minimax for every child recursively
+        for (int i = 0; i < node->childCount; i++) {
+			
+            treeNode *child = node->children[i];
+            makeGeneratedMove(pos, &child->lastMove, undo);
+            int value = simpleMinimax(child, pos, undo, stats, depth-1, maximizingColor);
+            unmakeMove(pos, undo);
+
+			// update best value found
+            if (value > bestVal) {
+                bestVal = value;
+    		}
+        }
+        node->valuation = bestVal;
+        return bestVal;
+	
+    } 
+	// case of min player
+	else {
+        int bestVal = INT_MAX;
+        for (int i = 0; i < node->childCount; i++) {
+
+            treeNode *child = node->children[i];
+            makeGeneratedMove(pos, &child->lastMove, undo);
+            int value = simpleMinimax(child, pos, undo, stats, depth-1, maximizingColor);
+            unmakeMove(pos, undo);
+            if (value < bestVal) {
+                bestVal = value;
+            }
+        }
+        node->valuation = bestVal;
+        return bestVal;
+    }
+}
+
+/**
+ * Minimax algo with alpa-beta prunning.
+ * Difference is we do not call minimax algo for every child recursively
+ * Instead we keep values a,b update them and
+ * if we find a value that we know it wont pe picked by the opponent 
+ * we cut the remaining childs of the node 
+ */
+int alphaBetaMinimax(treeNode *node, Position *pos, UndoStack *undo, SearchStats *stats, int depth, int alpha, int beta, char maximizingColor)
+{	
+	// define curent player
+    char currentPlayer = pos->turn;
+    stats->nodes++;
+
+	// leaf of the search, no need to look at the moves
+    if (depth == 0) {
+        COUNT_STAT(stats, leaves);
+        TIME_PHASE(stats, SEARCH_PHASE_EVAL, node->valuation = evaluatePosition(pos, maximizingColor));
+        return node->valuation;
+    }
+
+	// get the legal moves of both players in one pass
+	// they decide if the position is terminal, if we have to pass and which children we create
+    BitBoard mobility[2];
+    TIME_PHASE(stats, SEARCH_PHASE_MOVEGEN, getMobility(pos, mobility));
+
+	// check if a position is terminal 
+	// if yes return its value
+    if (bbIsEmpty(mobility[WHITE]) && bbIsEmpty(mobility[BLACK])) {
+        COUNT_STAT(stats, leaves);
+        TIME_PHASE(stats, SEARCH_PHASE_EVAL, node->valuation = evaluatePosition(pos, maximizingColor));
+        return node->valuation;
+    }
+
+	// expand the nodes childrens
+    int childCount;
+    TIME_PHASE(stats, SEARCH_PHASE_MOVEGEN, childCount = expandNode(node, pos, currentPlayer, mobility[(int) currentPlayer]));
+	// check if there are no available moves (children)
+    if (childCount == 0) {
+		// the position is not terminal, so the other player has moves 
+		// we have to simulate the other players turn since we lose ours
+		// play a null move switching the turn to the other player
+        Move passMove;
+        passMove.tile[0] = NULL_MOVE;
+        passMove.color   = currentPlayer;
+        makeMove(pos, &passMove, undo);
+
+		// create a temporary node to call a new minimax for our next turn
+        treeNode *tempNode = createTreeNode(pos, NULL);
+
+		// call minimax to find oure next turns value
+		node->valuation = alphaBetaMinimax(tempNode, pos, undo, stats, depth-1, alpha, beta, maximizingColor);
+
+		freeTree(tempNode);
+        unmakeMove(pos, undo);
+
+		return node->valuation;
+    }
+
+	// case of max player
+    if (currentPlayer == maximizingColor) {
+		//  set best val to -oo
+        int bestVal = INT_MIN;
+		// call a-b pruning for  every child recursively until we stop when we find a smaller value of beta
+        for (int i=0; i<node->childCount; i++) {
+            treeNode *child = node->children[i];
+            makeGeneratedMove(pos, &child->lastMove, undo);
+            int value = alphaBetaMinimax(child, pos, undo, stats, depth-1, alpha, beta, maximizingColor);
+            unmakeMove(pos, undo);
+            if (value > bestVal) {
+                bestVal = value;
+            }
+            if (value > alpha) {
+                alpha = value;
+            }
+            // no need to search anymore cause we want select this case
+            if (beta <= alpha) {
+                COUNT_CUTOFF(stats, i);
+                break;
+            }
+        }
+        node->valuation = bestVal;
+        return bestVal;
+    } 
+	// case of min player
+	else {
+        int bestVal = INT_MAX;
+        for (int i=0; i<node->childCount; i++) {
+            treeNode *child = node->children[i];
+            makeGeneratedMove(pos, &child->lastMove, undo);
+            int value = alphaBetaMinimax(child, pos, undo, stats, depth-1, alpha, beta, maximizingColor);
+            unmakeMove(pos, undo);
+            if (value < bestVal) {
+                bestVal = value;
+            }
+            if (value < beta) {
+                beta = value;
+            }
+            // no need to search anymore cause we want select this case
+            if (beta <= alpha) {
+                COUNT_CUTOFF(stats, i);
+                break;
+            }
+        }
+        node->valuation = bestVal;
+        return bestVal;
+    }
+}
+
+/**
+ * Empties the killer moves and the history table, the best moves are looked up in tt (can be NULL)
+ */
+void initMoveOrdering(MoveOrdering *ordering, TranspositionTable *tt)
+{
+    memset(ordering, 0, sizeof(MoveOrdering));
+    ordering->tt = tt;
+    for (int ply = 0; ply < MAX_SEARCH_DEPTH; ply++) {
+        for (int k = 0; k < KILLER_SLOTS; k++) {
+            ordering->killers[ply][k].tile[0] = NULL_MOVE;
+        }
+    }
+}
+
+static int sameMove(const Move *a, const Move *b)
+{
+    return a->tile[0] == b->tile[0] && a->tile[1] == b->tile[1];
+}
+
+/**
+ * Orders the children of a node without playing them: the hash move first, then the killer moves of the ply,
+ * then the rest by the pieces they flip (what the valuation after the move grows with) and, among the moves
+ * that flip as many, by their history score. Insertion sort on the keys, children with the same key keep their order
+ */
+static void orderChildren(treeNode *node, const Position *pos, MoveOrdering *ordering, int ply, Move *hashMove)
+{
+    unsigned long long keys[MAX_CHILDREN];
+    int color = pos->turn;
+
+    for (int i = 0; i < node->childCount; i++) {
+        Move *move = &node->children[i]->lastMove.move;
+        // never more than BOARD_CELLS, so the keys of the hash move and the killers are above every other key
+        unsigned long long flips = bbCount(node->children[i]->lastMove.flips);
+
+        if (hashMove != NULL && sameMove(move, hashMove)) {
+            keys[i] = ORDER_HASH_MOVE;
+        } else if (ply < MAX_SEARCH_DEPTH && sameMove(move, &ordering->killers[ply][0])) {
+            keys[i] = ORDER_KILLER + 1;
+        } else if (ply < MAX_SEARCH_DEPTH && sameMove(move, &ordering->killers[ply][1])) {
+            keys[i] = ORDER_KILLER;
+        } else {
+            keys[i] = (flips << 32) | ordering->history[color][getCell(move->tile[0], move->tile[1])];
+        }
+    }
+
+    for (int i = 1; i < node->childCount; i++) {
+        treeNode *child = node->children[i];
+        unsigned long long key = keys[i];
+        int j = i - 1;
+        while (j >= 0 && keys[j] < key) {
+            node->children[j+1] = node->children[j];
+            keys[j+1] = keys[j];
+            j--;
+        }
+        node->children[j+1] = child;
+        keys[j+1] = key;
+    }
+}
+
+/**
+ * Remembers the move that caused a cutoff: it becomes the first killer of its ply and its history score grows
+ * by depth * depth, so the cutoffs close to the root count more than the ones close to the leaves
+ */
+static void recordCutoff(MoveOrdering *ordering, const Move *move, int ply, int depth)
+{
+    if (ply < MAX_SEARCH_DEPTH && !sameMove(move, &ordering->killers[ply][0])) {
+        ordering->killers[ply][1] = ordering->killers[ply][0];
+        ordering->killers[ply][0] = *move;
+    }
+
+    unsigned int *history = &ordering->history[(int) move->color][getCell(move->tile[0], move->tile[1])];
+    *history += depth * depth;
+    // keep the scores in 32 bits, halving all of them keeps their order
+    if (*history >= ORDER_HISTORY_MAX) {
+        for (int c = 0; c < 2; c++) {
+            for (int cell = 0; cell < BOARD_CELLS; cell++) {
+                ordering->history[c][cell] /= 2;
+            }
+        }
+    }
+}
+
+/**
+ * A simple yet effective change on the classic a-b pruning.
+ * Before we perform the a-b pruning algo we order the childrens of the node to promote pruning.
+ * The ordering does not play the children: the best move of an earlier visit of the position (in the
+ * transposition table) goes first, then the moves that caused cutoffs at the same ply (killers) and then
+ * the moves that flip more, the ones with the most cutoffs in the whole search (history) first on ties
+ */
+int alphaBetaMinimaxWithOrdering(treeNode *node, Position *pos, UndoStack *undo, SearchStats *stats, MoveOrdering *ordering, int depth, int alpha, int beta, char maximizingColor)
+{
+    // define curent player
+    char currentPlayer = pos->turn;
+    stats->nodes++;
+    // plies played from the root, passes included
+    int ply = undo->top;
+
+	// leaf of the search, no need to look at the moves
+    if (depth == 0) {
+        COUNT_STAT(stats, leaves);
+        TIME_PHASE(stats, SEARCH_PHASE_EVAL, node->valuation = evaluatePosition(pos, maximizingColor));
+        return node->valuation;
+    }
+
+	// get the legal moves of both players in one pass
+	// they decide if the position is terminal, if we have to pass and which children we create
+    BitBoard mobility[2];
+    TIME_PHASE(stats, SEARCH_PHASE_MOVEGEN, getMobility(pos, mobility));
+
+	// check if a position is terminal 
+	// if yes return its value
+    if (bbIsEmpty(mobility[WHITE]) && bbIsEmpty(mobility[BLACK])) {
+        COUNT_STAT(stats, leaves);
+        TIME_PHASE(stats, SEARCH_PHASE_EVAL, node->valuation = evaluatePosition(pos, maximizingColor));
+        return node->valuation;
+    }
+
+	// expand the nodes childrens
+    int childCount;
+    TIME_PHASE(stats, SEARCH_PHASE_MOVEGEN, childCount = expandNode(node, pos, currentPlayer, mobility[(int) currentPlayer]));
+	// check if there are no available moves (children)
+    if (childCount == 0) {
+		// the position is not terminal, so the other player has moves 
+		// we have to simulate the other players turn since we lose ours
+		// play a null move switching the turn to the other player
+        Move passMove;
+        passMove.tile[0] = NULL_MOVE;
+        passMove.color   = currentPlayer;
+        makeMove(pos, &passMove, undo);
+
+		// create a temporary node to call a new minimax for our next turn
+        treeNode *tempNode = createTreeNode(pos, NULL);
+
+		// call minimax to find oure next turns value
+		node->valuation = alphaBetaMinimaxWithOrdering(tempNode, pos, undo, stats, ordering, depth-1, alpha, beta, maximizingColor);
+
+		freeTree(tempNode);
+        unmakeMove(pos, undo);
+
+		return node->valuation;
+    }
+
+    //  Move Ordering 
+    TTData entry;
+    Move *hashMove = NULL;
+    if (ordering->tt != NULL) {
+        COUNT_STAT(stats, ttProbes);
+        if (ttProbe(ordering->tt, pos->hash, &entry)) {
+            COUNT_STAT(stats, ttHits);
+            if (entry.bestMove.tile[0] != NULL_MOVE) {
+                hashMove = &entry.bestMove;
+            }
+        }
+    }
+    TIME_PHASE(stats, SEARCH_PHASE_ORDERING, orderChildren(node, pos, ordering, ply, hashMove));
+
+    int alphaOrig = alpha;
+    int betaOrig = beta;
+    int bestVal;
+    int bestIndex = 0;
+
+    // case of max player
+    if (currentPlayer == maximizingColor) {
+        //  set best val to -oo
+        bestVal = INT_MIN;
+        // call a-b pruning for  every child recursively until we stop when we find a smaller value of beta
+        for (int i=0; i<node->childCount; i++) {
+            treeNode *child = node->children[i];
+            makeGeneratedMove(pos, &child->lastMove, undo);
+            int value = alphaBetaMinimaxWithOrdering(child, pos, undo, stats, ordering, depth-1, alpha, beta, maximizingColor);
+            unmakeMove(pos, undo);
+            if (value > bestVal) {
+                bestVal = value;
+                bestIndex = i;
+            }
+            if (value > alpha) alpha = value;
+            // no need to search anymore cause we want select this case
+            if (beta <= alpha) {
+                COUNT_CUTOFF(stats, i);
+                recordCutoff(ordering, &child->lastMove.move, ply, depth);
+                break;
+            }
+        }
+    }
+    // case of min player
+    else {
+        bestVal = INT_MAX;
+        for (int i=0; i<node->childCount; i++) {
+            treeNode *child = node->children[i];
+            makeGeneratedMove(pos, &child->lastMove, undo);
+            int value = alphaBetaMinimaxWithOrdering(child, pos, undo, stats, ordering, depth-1, alpha, beta, maximizingColor);
+            unmakeMove(pos, undo);
+            if (value < bestVal) {
+                bestVal = value;
+                bestIndex = i;
+            }
+            if (value < beta) beta = value;
+            // κλάδεμα
+            if (beta <= alpha) {
+                COUNT_CUTOFF(stats, i);
+                recordCutoff(ordering, &child->lastMove.move, ply, depth);
+                break;
+            }
+        }
+    }
+
+    // the table keeps scores for the player to move like negamax(), the min player sees our values negated
+    if (ordering->tt != NULL) {
+        int bound = bestVal <= alphaOrig ? TT_UPPER : (bestVal >= betaOrig ? TT_LOWER : TT_EXACT);
+        int score = bestVal;
+        if (currentPlayer != maximizingColor) {
+            score = -bestVal;
+            bound = bound == TT_UPPER ? TT_LOWER : (bound == TT_LOWER ? TT_UPPER : TT_EXACT);
+        }
+        ttStore(ordering->tt, pos->hash, depth, bound, score, &node->children[bestIndex]->lastMove.move);
+    }
+
+    node->valuation = bestVal;
+    return bestVal;
+}
+
+
+
+/**
+ * Orders the moves by the number of pieces they flip, the most first.
+ * Insertion sort, moves that flip as many keep their order
+ */
+void orderMovesByFlips(MoveList *list)
+{
+    int flips[MAX_MOVES];
+
+    for (int i = 0; i < list->count; i++) {
+        flips[i] = bbCount(list->moves[i].flips);
+    }
+    for (int i = 1; i < list->count; i++) {
+        GeneratedMove move = list->moves[i];
+        int key = flips[i];
+        int j = i - 1;
+        while (j >= 0 && flips[j] < key) {
+            list->moves[j+1] = list->moves[j];
+            flips[j+1] = flips[j];
+            j--;
+        }
+        list->moves[j+1] = move;
+        flips[j+1] = key;
+    }
+}
+
+/**
+ * Puts move first in list (if it is there), the others keep their places except the one it swaps with
+ */
+static void moveToFront(MoveList *list, Move *move)
+{
+    GeneratedMove *found = findGeneratedMove(list, move);
+    if (found != NULL) {
+        GeneratedMove tmp = list->moves[0];
+        list->moves[0] = *found;
+        *found = tmp;
+    }
+}
+
+/**
+ * Negamax with alpha-beta pruning, without a tree.
+ * Both players are handled by the same code: every value is from the point of view of the player to move,
+ * so the value of a child is the negated value it returns to its own player.
+ * The moves of a ply are generated in a MoveList on the stack, nothing is allocated during the search.
+ */
+int negamax(SearchInfo *info, int depth, int alpha, int beta)
+{
+    Position *pos = &info->pos;
+    char currentPlayer = pos->turn;
+
+    // every SEARCH_CHECK_NODES positions look at the clock and at the stop flag of the other threads,
+    // once the search has to stop every call returns at once
+    if ((++info->stats.nodes & (SEARCH_CHECK_NODES - 1)) == 0) {
+        if ((info->deadline > 0 && getTimeSeconds() >= info->deadline)
+            || (info->stop != NULL && __atomic_load_n(info->stop, __ATOMIC_RELAXED))) {
+            info->aborted = TRUE;
+        }
+    }
+    if (info->aborted) {
+        return 0;
+    }
+
+    // leaf of the search, value for the player to move
+    if (depth == 0) {
+        info->reachedDepthLimit = TRUE;
+        COUNT_STAT(&info->stats, leaves);
+        int value;
+        TIME_PHASE(&info->stats, SEARCH_PHASE_EVAL, value = evaluatePosition(pos, currentPlayer));
+        return value;
+    }
+
+    // a search of this position from another move order may already be in the table
+    TTData entry;
+    entry.bestMove.tile[0] = NULL_MOVE;
+    if (info->tt != NULL) {
+        COUNT_STAT(&info->stats, ttProbes);
+        if (ttProbe(info->tt, pos->hash, &entry)) {
+            COUNT_STAT(&info->stats, ttHits);
+            // the lines below the entry may have been cut by the depth, so we cannot tell this iteration was the last one
+            if (entry.depth >= depth
+                && (entry.bound == TT_EXACT
+                    || (entry.bound == TT_LOWER && entry.score >= beta)
+                    || (entry.bound == TT_UPPER && entry.score <= alpha))) {
+                info->reachedDepthLimit = TRUE;
+                return entry.score;
+            }
+        }
+    }
+
+    // get the legal moves of both players in one pass
+    BitBoard mobility[2];
+    TIME_PHASE(&info->stats, SEARCH_PHASE_MOVEGEN, getMobility(pos, mobility));
+
+    // terminal position, nobody can move
+    if (bbIsEmpty(mobility[WHITE]) && bbIsEmpty(mobility[BLACK])) {
+        COUNT_STAT(&info->stats, leaves);
+        int value;
+        TIME_PHASE(&info->stats, SEARCH_PHASE_EVAL, value = evaluatePosition(pos, currentPlayer));
+        return value;
+    }
+
+    // we cannot move but the other player can, pass the turn
+    if (bbIsEmpty(mobility[(int) currentPlayer])) {
+        Move passMove;
+        passMove.tile[0] = NULL_MOVE;
+        passMove.color   = currentPlayer;
+        makeMove(pos, &passMove, &info->undo);
+        int value = -negamax(info, depth-1, -beta, -alpha);
+        unmakeMove(pos, &info->undo);
+        return value;
+    }
+
+    MoveList list;
+    TIME_PHASE(&info->stats, SEARCH_PHASE_MOVEGEN, generateMovesFromSet(pos, currentPlayer, mobility[(int) currentPlayer], &list));
+
+    // the best move of an earlier search of this position is tried first
+    if (entry.bestMove.tile[0] != NULL_MOVE) {
+        TIME_PHASE(&info->stats, SEARCH_PHASE_ORDERING, moveToFront(&list, &entry.bestMove));
+    }
+
+    int alphaOrig = alpha;
+    int bestVal = -SEARCH_INFINITY;
+    int bestIndex = 0;
+    for (int i = 0; i < list.count; i++) {
+        makeGeneratedMove(pos, &list.moves[i], &info->undo);
+        int value = -negamax(info, depth-1, -beta, -alpha);
+        unmakeMove(pos, &info->undo);
+
+        if (info->aborted) {
+            return 0;
+        }
+        if (value > bestVal) {
+            bestVal = value;
+            bestIndex = i;
+        }
+        if (value > alpha) {
+            alpha = value;
+        }
+        // the opponent will never let us reach this position
+        if (alpha >= beta) {
+            COUNT_CUTOFF(&info->stats, i);
+            break;
+        }
+    }
+
+    if (info->tt != NULL) {
+        int bound = bestVal <= alphaOrig ? TT_UPPER : (bestVal >= beta ? TT_LOWER : TT_EXACT);
+        ttStore(info->tt, pos->hash, depth, bound, bestVal, &list.moves[bestIndex].move);
+    }
+    return bestVal;
+}
+
+/**
+ * Principal Variation Search (NegaScout), negamax() with null windows.
+ * The first move (the hash move when there is one) is searched with the full window, every other move
+ * with the null window (alpha, alpha + 1) that only tells if it is better than alpha.
+ * A move that turns out better is searched again with the full window to get its value
+ */
+int principalVariationSearch(SearchInfo *info, int depth, int alpha, int beta)
+{
+    Position *pos = &info->pos;
+    char currentPlayer = pos->turn;
+
+    // every SEARCH_CHECK_NODES positions look at the clock and at the stop flag of the other threads,
+    // once the search has to stop every call returns at once
+    if ((++info->stats.nodes & (SEARCH_CHECK_NODES - 1)) == 0) {
+        if ((info->deadline > 0 && getTimeSeconds() >= info->deadline)
+            || (info->stop != NULL && __atomic_load_n(info->stop, __ATOMIC_RELAXED))) {
+            info->aborted = TRUE;
+        }
+    }
+    if (info->aborted) {
+        return 0;
+    }
+
+    // leaf of the search, value for the player to move
+    if (depth == 0) {
+        info->reachedDepthLimit = TRUE;
+        COUNT_STAT(&info->stats, leaves);
+        int value;
+        TIME_PHASE(&info->stats, SEARCH_PHASE_EVAL, value = evaluatePosition(pos, currentPlayer));
+        return value;
+    }
+
+    // a search of this position from another move order may already be in the table
+    TTData entry;
+    entry.bestMove.tile[0] = NULL_MOVE;
+    if (info->tt != NULL) {
+        COUNT_STAT(&info->stats, ttProbes);
+        if (ttProbe(info->tt, pos->hash, &entry)) {
+            COUNT_STAT(&info->stats, ttHits);
+            // the lines below the entry may have been cut by the depth, so we cannot tell this iteration was the last one
+            if (entry.depth >= depth
+                && (entry.bound == TT_EXACT
+                    || (entry.bound == TT_LOWER && entry.score >= beta)
+                    || (entry.bound == TT_UPPER && entry.score <= alpha))) {
+                info->reachedDepthLimit = TRUE;
+                return entry.score;
+            }
+        }
+    }
+
+    // get the legal moves of both players in one pass
+    BitBoard mobility[2];
+    TIME_PHASE(&info->stats, SEARCH_PHASE_MOVEGEN, getMobility(pos, mobility));
+
+    // terminal position, nobody can move
+    if (bbIsEmpty(mobility[WHITE]) && bbIsEmpty(mobility[BLACK])) {
+        COUNT_STAT(&info->stats, leaves);
+        int value;
+        TIME_PHASE(&info->stats, SEARCH_PHASE_EVAL, value = evaluatePosition(pos, currentPlayer));
+        return value;
+    }
+
+    // we cannot move but the other player can, pass the turn
+    if (bbIsEmpty(mobility[(int) currentPlayer])) {
+        Move passMove;
+        passMove.tile[0] = NULL_MOVE;
+        passMove.color   = currentPlayer;
+        makeMove(pos, &passMove, &info->undo);
+        int value = -principalVariationSearch(info, depth-1, -beta, -alpha);
+        unmakeMove(pos, &info->undo);
+        return value;
+    }
+
+    MoveList list;
+    TIME_PHASE(&info->stats, SEARCH_PHASE_MOVEGEN, generateMovesFromSet(pos, currentPlayer, mobility[(int) currentPlayer], &list));
+    TIME_PHASE(&info->stats, SEARCH_PHASE_ORDERING, orderMovesByFlips(&list));
+
+    // the best move of an earlier search of this position is tried first
+    if (entry.bestMove.tile[0] != NULL_MOVE) {
+        TIME_PHASE(&info->stats, SEARCH_PHASE_ORDERING, moveToFront(&list, &entry.bestMove));
+    }
+
+    int alphaOrig = alpha;
+    int bestVal = -SEARCH_INFINITY;
+    int bestIndex = 0;
+    for (int i = 0; i < list.count; i++) {
+        makeGeneratedMove(pos, &list.moves[i], &info->undo);
+        int value;
+        if (i == 0) {
+            value = -principalVariationSearch(info, depth-1, -beta, -alpha);
+        } else {
+            // only prove that the move is not better than the best one so far
+            value = -principalVariationSearch(info, depth-1, -alpha-1, -alpha);
+            // it is better, search it again to get its value
+            if (value > alpha && value < beta && !info->aborted) {
+                value = -principalVariationSearch(info, depth-1, -beta, -alpha);
+            }
+        }
+        unmakeMove(pos, &info->undo);
+
+        if (info->aborted) {
+            return 0;
+        }
+        if (value > bestVal) {
+            bestVal = value;
+            bestIndex = i;
+        }
+        if (value > alpha) {
+            alpha = value;
+        }
+        // the opponent will never let us reach this position
+        if (alpha >= beta) {
+            COUNT_CUTOFF(&info->stats, i);
+            break;
+        }
+    }
+
+    if (info->tt != NULL) {
+        int bound = bestVal <= alphaOrig ? TT_UPPER : (bestVal >= beta ? TT_LOWER : TT_EXACT);
+        ttStore(info->tt, pos->hash, depth, bound, bestVal, &list.moves[bestIndex].move);
+    }
+    return bestVal;
+}
+
+/**
+ * Monotonic clock in seconds, not affected by changes of the system time
+ */
+double getTimeSeconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+void addSearchStats(SearchStats *total, const SearchStats *stats)
+{
+    total->nodes        += stats->nodes;
+    total->leaves       += stats->leaves;
+    total->cutoffs      += stats->cutoffs;
+    total->firstCutoffs += stats->firstCutoffs;
+    total->ttProbes     += stats->ttProbes;
+    total->ttHits       += stats->ttHits;
+    for (int p = 0; p < NUM_SEARCH_PHASES; p++) {
+        total->phaseCalls[p]         += stats->phaseCalls[p];
+        total->phaseSamples[p]       += stats->phaseSamples[p];
+        total->phaseSampleSeconds[p] += stats->phaseSampleSeconds[p];
+    }
+}
+
+double phaseClockOverhead = 0;
+static pthread_once_t phaseTimingOnce = PTHREAD_ONCE_INIT;
+
+/**
+ * The cheapest of many back to back clock reads, so a sample does not count the clock itself
+ */
+static void measureClockOverhead(void)
+{
+    double best = 1;
+    for (int i = 0; i < 1000; i++) {
+        double t = getTimeSeconds();
+        double elapsed = getTimeSeconds() - t;
+        if (elapsed < best) {
+            best = elapsed;
+        }
+    }
+    phaseClockOverhead = best;
+}
+
+void initPhaseTiming(void)
+{
+    pthread_once(&phaseTimingOnce, measureClockOverhead);
+}
+
+/**
+ * The time of all the calls of a phase, the average of its samples times its calls
+ */
+double searchPhaseSeconds(const SearchStats *stats, int phase)
+{
+    if (stats->phaseSamples[phase] == 0) {
+        return 0;
+    }
+    return stats->phaseSampleSeconds[phase] / stats->phaseSamples[phase] * stats->phaseCalls[phase];
+}
+
+/**
+ * The branching factor b of a uniform tree with as many nodes at that depth, nodes = b^depth
+ */
+double effectiveBranchingFactor(unsigned long long nodes, int depth)
+{
+    if (nodes == 0 || depth <= 0) {
+        return 0;
+    }
+    return pow((double) nodes, 1.0 / depth);
+}
+
+/**
+ * One iteration at the root with the window (alpha, beta), with negamax() or with principalVariationSearch().
+ * The move at list->moves[0] is searched first, it is the best one of the previous iteration.
+ * Returns the index of the first move with the best value and that value in score (at most alpha if every move
+ * failed low, at least beta if one failed high), -1 if the search stopped before the iteration finished
+ */
+static int negamaxRoot(SearchInfo *info, MoveList *list, int depth, int alpha, int beta, int pvs, int *score)
+{
+    int bestIndex = -1;
+    int bestVal = -SEARCH_INFINITY;
+
+    for (int i = 0; i < list->count; i++) {
+        makeGeneratedMove(&info->pos, &list->moves[i], &info->undo);
+        int value;
+        if (!pvs) {
+            value = -negamax(info, depth-1, -beta, -alpha);
+        } else if (i == 0) {
+            value = -principalVariationSearch(info, depth-1, -beta, -alpha);
+        } else {
+            value = -principalVariationSearch(info, depth-1, -alpha-1, -alpha);
+            if (value > alpha && value < beta && !info->aborted) {
+                value = -principalVariationSearch(info, depth-1, -beta, -alpha);
+            }
+        }
+        unmakeMove(&info->pos, &info->undo);
+
+        if (info->aborted) {
+            return -1;
+        }
+        // only a better move replaces the best one, so ties keep the first move like the tree searches
+        if (value > bestVal) {
+            bestVal = value;
+            bestIndex = i;
+        }
+        if (value > alpha) {
+            alpha = value;
+        }
+        if (alpha >= beta) {
+            break;
+        }
+    }
+    *score = bestVal;
+    return bestIndex;
+}
+
+/**
+ * One thread of the negamax search. Thread 0 is the main thread and its move is the one we play.
+ * The other threads (-t) search the same root on their own copy of the position, odd ones one ply deeper
+ * and each with the root moves in another order, and help the main thread only through the shared table
+ */
+typedef struct {
+    SearchInfo info;
+    MoveList rootMoves;           // searched in this order, the best move of each iteration goes first
+    int index;
+    int maxDepth;
+    int pvs;                      // search with principalVariationSearch() and aspiration windows instead of negamax()
+    double start;
+    Move bestMove;                // best move of the last finished iteration
+    int bestScore;                // and its value
+    int completedDepth;
+    pthread_t thread;
+} SearchThread;
+
+/**
+ * Iterative deepening over negamaxRoot(): depth 1, 2, ... until maxDepth or until the search has to stop.
+ * The iterations share the transposition table (can be NULL), it also keeps what was found for the previous moves.
+ * Only the main thread decides when to stop, the helpers run until it tells them
+ */
+static void iterativeDeepening(SearchThread *thread)
+{
+    SearchInfo *info = &thread->info;
+    MoveList *list = &thread->rootMoves;
+
+    int score = 0;
+    int scores[MAX_SEARCH_DEPTH + 1];     // score of each finished iteration
+
+    for (int depth = 1 + (thread->index & 1); depth <= thread->maxDepth; depth++) {
+        info->reachedDepthLimit = FALSE;
+
+        // PVS expects a score close to the one of an earlier iteration and searches a small window around it.
+        // The disc difference swings between odd and even depths, so the guess is the score two plies less deep.
+        // When the score falls outside, that side of the window is widened and the iteration searched again
+        int alpha = -SEARCH_INFINITY;
+        int beta = SEARCH_INFINITY;
+        int delta = ASPIRATION_WINDOW;
+        int firstDepth = 1 + (thread->index & 1);
+        if (thread->pvs && depth > firstDepth) {
+            int guess = depth - 2 >= firstDepth ? scores[depth - 2] : scores[depth - 1];
+            alpha = guess - delta > -SEARCH_INFINITY ? guess - delta : -SEARCH_INFINITY;
+            beta = guess + delta < SEARCH_INFINITY ? guess + delta : SEARCH_INFINITY;
+        }
+
+        int bestIndex;
+        for (;;) {
+            bestIndex = negamaxRoot(info, list, depth, alpha, beta, thread->pvs, &score);
+            if (bestIndex < 0) {
+                break;
+            }
+            delta *= 2;
+            if (score <= alpha && alpha > -SEARCH_INFINITY) {
+                alpha = score - delta > -SEARCH_INFINITY ? score - delta : -SEARCH_INFINITY;
+            } else if (score >= beta && beta < SEARCH_INFINITY) {
+                beta = score + delta < SEARCH_INFINITY ? score + delta : SEARCH_INFINITY;
+            } else {
+                break;
+            }
+        }
+        if (bestIndex < 0) {
+            break;
+        }
+        scores[depth] = score;
+        thread->bestMove = list->moves[bestIndex].move;
+        thread->bestScore = score;
+        thread->completedDepth = depth;
+
+        // the next iteration starts with the best move, the order of the others stays the same
+        GeneratedMove best = list->moves[bestIndex];
+        memmove(&list->moves[1], &list->moves[0], bestIndex * sizeof(GeneratedMove));
+        list->moves[0] = best;
+
+        if (thread->index == 0) {
+            // every line reached the end of the game, deeper iterations would find the same
+            if (!info->reachedDepthLimit) {
+                break;
+            }
+            // the next iteration takes a few times longer than this one, do not start what we cannot finish
+            if (info->deadline > 0 && getTimeSeconds() - thread->start > (info->deadline - thread->start) / 2) {
+                break;
+            }
+        }
+    }
+}
+
+static void *runSearchThread(void *arg)
+{
+    iterativeDeepening((SearchThread *) arg);
+    return NULL;
+}
+
+/**
+ * Lazy SMP: options->threads threads run iterativeDeepening() on the same root, sharing the transposition table.
+ * pvs chooses principalVariationSearch() instead of negamax().
+ * Returns the best move of the last iteration the main thread finished (NULL move if we have none)
+ */
+static Move parallelSearch(Position *rootPos, const SearchOptions *options, SearchReport *report, int pvs)
+{
+    int threadCount = options->threads > 1 ? options->threads : 1;
+    int stop = FALSE;
+    double start = getTimeSeconds();
+
+    Move bestMove;
+    bestMove.tile[0] = NULL_MOVE;
+    bestMove.color   = rootPos->turn;
+
+    SearchThread *threads = (SearchThread *) malloc(threadCount * sizeof(SearchThread));
+    if (threads == NULL) {
+        return bestMove;
+    }
+
+    if (options->tt != NULL) {
+        ttNewSearch(options->tt);
+    }
+
+    for (int i = 0; i < threadCount; i++) {
+        SearchThread *t = &threads[i];
+        memcpy(&t->info.pos, rootPos, sizeof(Position));
+        initUndoStack(&t->info.undo);
+        memset(&t->info.stats, 0, sizeof(SearchStats));
+        t->info.aborted = FALSE;
+        t->info.tt = options->tt;
+        // the main thread also stops when the caller says so, the helpers when the main thread is done
+        t->info.stop = i == 0 && options->stop != NULL ? options->stop : &stop;
+        t->info.deadline = options->timeLimitMs > 0 ? start + options->timeLimitMs / 1000.0 : 0;
+        t->index = i;
+        t->maxDepth = options->maxDepth;
+        t->pvs = pvs;
+        t->start = start;
+        t->bestScore = 0;
+        t->completedDepth = 0;
+
+        generateMoves(&t->info.pos, t->info.pos.turn, &t->rootMoves);
+        if (t->rootMoves.count == 0) {
+            free(threads);
+            return bestMove;
+        }
+        // if not even depth 1 finishes we still play a legal move
+        t->bestMove = t->rootMoves.moves[0].move;
+
+        // the helpers start from another root move
+        for (int r = 0; r < i % t->rootMoves.count; r++) {
+            GeneratedMove first = t->rootMoves.moves[0];
+            memmove(&t->rootMoves.moves[0], &t->rootMoves.moves[1], (t->rootMoves.count - 1) * sizeof(GeneratedMove));
+            t->rootMoves.moves[t->rootMoves.count - 1] = first;
+        }
+    }
+
+    // if a thread cannot be created we go on with the ones we have
+    int started = 1;
+    while (started < threadCount && pthread_create(&threads[started].thread, NULL, runSearchThread, &threads[started]) == 0) {
+        started++;
+    }
+
+    iterativeDeepening(&threads[0]);
+
+    __atomic_store_n(&stop, TRUE, __ATOMIC_RELAXED);
+    for (int i = 1; i < started; i++) {
+        pthread_join(threads[i].thread, NULL);
+    }
+
+    bestMove = threads[0].bestMove;
+
+    if (report != NULL) {
+        report->depth = threads[0].completedDepth;
+        report->score = threads[0].bestScore;
+        memset(&report->stats, 0, sizeof(SearchStats));
+        for (int i = 0; i < started; i++) {
+            addSearchStats(&report->stats, &threads[i].info.stats);
+        }
+        report->seconds = getTimeSeconds() - start;
+    }
+
+    free(threads);
+    return bestMove;
+}
+
+Move findBestMove(Position *rootPos, char myCol, int alg, const SearchOptions *options, SearchReport *report)
+{
+    initPhaseTiming();
+
+    // close to the end the whole game is solved, whatever the algorithm. The solver gets half of the time,
+    // if it cannot finish the algorithm searches as usual with what is left
+    int empties = bbCount(rootPos->empty);
+    if (options->endgameEmpties > 0 && empties <= options->endgameEmpties + ENDGAME_WLD_EXTRA) {
+        int mode = empties <= options->endgameEmpties ? ENDGAME_EXACT : ENDGAME_WIN_LOSS_DRAW;
+        double start = getTimeSeconds();
+        double deadline = options->timeLimitMs > 0 ? start + options->timeLimitMs / 2000.0 : 0;
+        int solved;
+        Move move = endgameSearch(rootPos, options, mode, deadline, report, &solved);
+        if (solved) {
+            return move;
+        }
+
+        SearchOptions rest = *options;
+        rest.endgameEmpties = 0;
+        if (options->timeLimitMs > 0) {
+            rest.timeLimitMs = options->timeLimitMs - (int) ((getTimeSeconds() - start) * 1000);
+            rest.timeLimitMs = rest.timeLimitMs > 1 ? rest.timeLimitMs : 1;
+        }
+        return findBestMove(rootPos, myCol, alg, &rest, report);
+    }
+
+    // the negamax search needs no tree
+    if (alg == ALG_NEGAMAX || alg == ALG_PVS) {
+        return parallelSearch(rootPos, options, report, alg == ALG_PVS);
+    }
+    if (alg == ALG_YBWC) {
+        return ybwcSearch(rootPos, options, report);
+    }
+
+    SearchStats stats;
+    double start = getTimeSeconds();
+    memset(&stats, 0, sizeof(SearchStats));
+
+    treeNode* root = createTreeNode(rootPos, NULL);
+
+    // the whole search runs on a single copy of the root position
+    Position pos;
+    UndoStack undo;
+    memcpy(&pos, rootPos, sizeof(Position));
+    initUndoStack(&undo);
+
+    int bestVal = 0;
+    switch (alg) {
+        case 0:
+            bestVal = simpleMinimax(root, &pos, &undo, &stats, options->maxDepth, myCol);
+            break;
+        case 1:
+            bestVal = alphaBetaMinimax(root, &pos, &undo, &stats, options->maxDepth, INT_MIN, INT_MAX, myCol);
+            break;
+        case 2: {
+            // the killers and the history are learned during this search, the table keeps the best moves of the game
+            MoveOrdering ordering;
+            initMoveOrdering(&ordering, options->tt);
+            if (options->tt != NULL) {
+                ttNewSearch(options->tt);
+            }
+            bestVal = alphaBetaMinimaxWithOrdering(root, &pos, &undo, &stats, &ordering, options->maxDepth, INT_MIN, INT_MAX, myCol);
+            break;
+        }
+        default:
+            bestVal = alphaBetaMinimax(root, &pos, &undo, &stats, options->maxDepth, INT_MIN, INT_MAX, myCol);
+            break;
+    }
+
+    if (report != NULL) {
+        report->depth = options->maxDepth;
+        report->score = bestVal;
+        report->stats = stats;
+        report->seconds = getTimeSeconds() - start;
+    }
+
+    // now we have to find the child that led to the best valuation calculated
+    Move bestMove;
+    bestMove.tile[0] = NULL_MOVE;
+
+    // first check it they were no available moves so return NULL
+    if (root->childCount == 0) {
+        freeTree(root);
+        return bestMove;
+    }
+
+
+    // search every children to find the one with the best value calculated 
+    for (int i=0; i < root->childCount; i++) {
+        if (root->children[i]->valuation == bestVal) {
+            bestMove = root->children[i]->lastMove.move;
+            break;
+        }
+    }
+
+    freeTree(root);
+    return bestMove;
+}
@@ -0,0 +1,192 @@
+#ifndef _SEARCH_H
+#define _SEARCH_H
+
+#include "global.h"
+#include "board.h"
+#include "move.h"
+#include "tt.h"
+
+/**********************************************************/
+
+#define MAX_CHILDREN 300   	// max number of available moves at each positio
+#define ΜΑΧ_DEPTH 3     	// default depth for the search algos (-d)
+
+/* The algorithms findBestMove() can run (the -a option of the client) */
+#define ALG_SIMPLE_MINIMAX 0
+#define ALG_ALPHA_BETA 1
+#define ALG_ALPHA_BETA_ORDERING 2
+#define ALG_NEGAMAX 3
+#define ALG_YBWC 4
+#define ALG_PVS 5
+#define NUM_ALGORITHMS 6
+
+/* How many positions negamax() visits between two looks at the clock (a power of 2) */
+#define SEARCH_CHECK_NODES 1024
+
+/* Deepest iteration of the iterative deepening, a whole game fits in it */
+#define MAX_SEARCH_DEPTH 64
+
+/* Half width of the first aspiration window of PVS around the score of an earlier iteration */
+#define ASPIRATION_WINDOW 4
+
+/* Move ordering of alphaBetaMinimaxWithOrdering(): killer moves kept per ply, the cap of the history scores
+ * and the ordering keys of the hash move and the killers, above the flips and history of any other move */
+#define KILLER_SLOTS 2
+#define ORDER_HISTORY_MAX ( 1u << 30 )
+#define ORDER_KILLER ( 1ULL << 48 )
+#define ORDER_HASH_MOVE ( ORDER_KILLER + 2 )
+
+/* The parts of a search timed on their own (SearchStats.phaseSeconds), the rest of its time is the tree walk */
+#define SEARCH_PHASE_MOVEGEN 0     // legal moves and their flips
+#define SEARCH_PHASE_EVAL 1        // values of the leaves
+#define SEARCH_PHASE_ORDERING 2    // sorting the moves before they are searched
+#define NUM_SEARCH_PHASES 3
+
+/* A phase looks at the clock in about one call in 2^PHASE_SAMPLE_BITS, the samples stand for all the calls.
+ * A sample longer than PHASE_SAMPLE_MAX_SECONDS was interrupted by the system and is left out */
+#define PHASE_SAMPLE_BITS 5
+#define PHASE_SAMPLE_MAX_SECONDS 1e-4
+
+/* Bigger than any score difference, so -SEARCH_INFINITY .. SEARCH_INFINITY is a full window */
+#define SEARCH_INFINITY ( BOARD_CELLS + 1 )
+
+/**
+ * 	Struct treeNode used for searching in a tree form
+ * 	It represents a certain state of a game given by the last move led to it and the next available moves
+ *  The position itself is not stored, the search plays the moves on one shared position
+ *  with makeMove() while going down the tree and takes them back with unmakeMove()
+ *
+ */
+
+typedef struct treeNode {
+    GeneratedMove lastMove;      				// last move that brought us here and the pieces it flipped
+    int valuation;               				// value of the certain node
+    struct treeNode *children[MAX_CHILDREN];	// next available states (nodes)
+    int childCount;								// number of children of current node
+} treeNode;
+
+/**
+ *  What a search counts, for the statistics of the client. The nodes are always counted (the searches look
+ *  at the clock by them), the other counters are one increment each and compiled out with -DNO_SEARCH_STATS
+ */
+typedef struct {
+    unsigned long long nodes;          // positions visited
+    unsigned long long leaves;         // positions evaluated: the depth ran out or the game is over
+    unsigned long long cutoffs;        // nodes left early because a move reached beta
+    unsigned long long firstCutoffs;   // cutoffs by the first move tried, the more the better the ordering
+    unsigned long long ttProbes;       // lookups in the transposition table
+    unsigned long long ttHits;         // lookups that found the position
+    unsigned long long phaseCalls[NUM_SEARCH_PHASES];
+    unsigned long long phaseSamples[NUM_SEARCH_PHASES];
+    double phaseSampleSeconds[NUM_SEARCH_PHASES];   // of the samples only, see searchPhaseSeconds()
+} SearchStats;
+
+#ifdef NO_SEARCH_STATS
+#define COUNT_STAT(stats, field) ((void) 0)
+#define COUNT_CUTOFF(stats, moveIndex) ((void) 0)
+#define TIME_PHASE(stats, phase, statement) do { statement; } while (0)
+#else
+#define COUNT_STAT(stats, field) ((stats)->field++)
+#define COUNT_CUTOFF(stats, moveIndex) ((stats)->cutoffs++, (stats)->firstCutoffs += (moveIndex) == 0)
+#define TIME_PHASE(stats, phase, statement) do { \
+        double phaseStarted = phaseSampleStart(stats, phase); \
+        statement; \
+        phaseSampleEnd(stats, phase, phaseStarted); \
+    } while (0)
+#endif
+
+/**
+ *  What alphaBetaMinimaxWithOrdering() learns about the moves while it searches, to try the moves that
+ *  caused cutoffs before the others. One per search, the table can be kept between the searches
+ */
+typedef struct {
+    TranspositionTable *tt;                        // best move of each position searched, NULL to order without it
+    Move killers[MAX_SEARCH_DEPTH][KILLER_SLOTS];  // the last moves that caused a cutoff at each ply, newest first
+    unsigned int history[2][BOARD_CELLS];          // how much each cell caused cutoffs for each color
+} MoveOrdering;
+
+/**
+ *  Everything the negamax search works on. There is no tree: the moves of each ply live in a
+ *  MoveList on the stack of negamax() and are played on pos and taken back with undo
+ */
+typedef struct {
+    Position pos;                  // the position being searched, one copy for the whole search
+    UndoStack undo;                // the moves played on pos from the root
+    SearchStats stats;             // positions visited and the other counters
+    double deadline;               // monotonic time (getTimeSeconds()) to stop at, 0 for no limit
+    int aborted;                   // set when the deadline passed, the values of the iteration are useless
+    int reachedDepthLimit;         // some line was cut by the depth, a deeper iteration may see more
+    TranspositionTable *tt;        // results of positions already searched, NULL to search without a table
+    const int *stop;               // set by another thread when this search has to stop, can be NULL
+} SearchInfo;
+
+/**
+ *  How findBestMove() searches. The tree algorithms always search maxDepth plies, the negamax, YBWC
+ *  and PVS ones deepen one ply at a time up to maxDepth until timeLimitMs runs out, in threads threads
+ */
+typedef struct {
+    int maxDepth;                  // deepest iteration (1 .. MAX_SEARCH_DEPTH)
+    int timeLimitMs;               // time for one move in ms, 0 for no limit
+    int threads;                   // threads of the negamax and PVS searches (they share tt) or of the YBWC one
+    TranspositionTable *tt;        // kept between the moves of a game, NULL to search without a table
+    const int *stop;               // set by another thread to end the negamax or PVS search at once (pondering), can be NULL
+    int endgameEmpties;            // with this many empty cells or less the game is solved exactly (see endgame.h), 0 never
+} SearchOptions;
+
+/* What findBestMove() did, for the statistics */
+typedef struct {
+    int depth;                     // deepest iteration finished by the main thread (the empties for the endgame solver)
+    int score;                     // value of the move for the side that plays it at that depth (only its sign for a win/loss/draw solve)
+    SearchStats stats;             // summed over all the threads
+    double seconds;
+} SearchReport;
+
+/**********************************************************/
+
+treeNode* createTreeNode(const Position *p, const GeneratedMove *move);
+void freeTree(treeNode *node);
+int isTerminalPosition(const Position *position);
+int evaluatePosition(const Position *pos, char maximizingColor);
+int expandNode(treeNode *node, Position *pos, char currentColor, BitBoard legalMoves);
+int simpleMinimax(treeNode *node, Position *pos, UndoStack *undo, SearchStats *stats, int depth, char maximizingColor);
+int alphaBetaMinimax(treeNode *node, Position *pos, UndoStack *undo, SearchStats *stats, int depth, int alpha, int beta, char maximizingColor);
+void initMoveOrdering(MoveOrdering *ordering, TranspositionTable *tt);
+int alphaBetaMinimaxWithOrdering(treeNode *node, Position *pos, UndoStack *undo, SearchStats *stats, MoveOrdering *ordering, int depth, int alpha, int beta, char maximizingColor);
+void orderMovesByFlips(MoveList *list);
+int negamax(SearchInfo *info, int depth, int alpha, int beta);
+int principalVariationSearch(SearchInfo *info, int depth, int alpha, int beta);
+double getTimeSeconds(void);
+void addSearchStats(SearchStats *total, const SearchStats *stats);
+double effectiveBranchingFactor(unsigned long long nodes, int depth);
+void initPhaseTiming(void);
+double searchPhaseSeconds(const SearchStats *stats, int phase);
+Move findBestMove(Position *rootPos, char myCol, int alg, const SearchOptions *options, SearchReport *report);
+
+/**********************************************************/
+
+/* What reading the clock twice costs, measured once by initPhaseTiming() and taken off every sample */
+extern double phaseClockOverhead;
+
+/**
+ * TIME_PHASE() runs its statement between these two. A sampled call returns the time it started, the others 0.
+ * The calls are picked by a multiplicative hash of their number: with a fixed stride a phase timed at two places
+ * that take turns (the moves of a node, then the flips of its children) would always sample the same one
+ */
+static inline double phaseSampleStart(SearchStats *stats, int phase)
+{
+    unsigned long long call = ++stats->phaseCalls[phase];
+    return (call * 0x9E3779B97F4A7C15ULL) >> (64 - PHASE_SAMPLE_BITS) == 0 ? getTimeSeconds() : 0;
+}
+
+static inline void phaseSampleEnd(SearchStats *stats, int phase, double started)
+{
+    if (started > 0) {
+        double seconds = getTimeSeconds() - started - phaseClockOverhead;
+        if (seconds < PHASE_SAMPLE_MAX_SECONDS) {
+            stats->phaseSamples[phase]++;
+            stats->phaseSampleSeconds[phase] += seconds > 0 ? seconds : 0;
+        }
+    }
+}
+
+#endif
@@ -16,6 +16,7 @@ int main( int argc, char **argv )
 
 
 	int c;
+	BitBoard legalMoves;
 	opterr = 0;
 
 	while( ( c = getopt( argc, argv, "p:g:hs" ) ) != -1 )
@@ -104,7 +105,9 @@ int main( int argc, char **argv )
 			tempMove.color = playingPlayer->color;
 
 			//check legality
-			if( !canMove( &gamePosition, playingPlayer->color ) )	//if that player cannot move, the only legal move is null
+			legalMoves = getLegalMoves( &gamePosition, playingPlayer->color );
+
+			if( bbIsEmpty( legalMoves ) )	//if that player cannot move, the only legal move is null
 			{
 				if( tempMove.tile[ 0 ] != NULL_MOVE )	//technical loss
 				{
@@ -116,7 +119,7 @@ int main( int argc, char **argv )
 			}
 			else
 			{
-				if( !isLegalMove( &gamePosition, &tempMove ) )
+				if( !isMoveInSet( legalMoves, &tempMove ) )
 				{
 					//technical loss
 					printf( "Player: %s tried an illegal move and lost the game!\nIllegal move:", playingPlayer->name );
@@ -0,0 +1,214 @@
+#include "stats.h"
+#include <stdlib.h>
+#include <string.h>
+
+
+/**
+ * part as a percentage of whole, 0 when there is no whole
+ */
+static double percent(unsigned long long part, unsigned long long whole)
+{
+    return whole > 0 ? 100.0 * part / whole : 0;
+}
+
+static double nodesPerSecond(unsigned long long nodes, double seconds)
+{
+    return seconds > 0 ? nodes / seconds : 0;
+}
+
+void statsInit(MatchStats *match)
+{
+    memset(match, 0, sizeof(MatchStats));
+}
+
+void statsFree(MatchStats *match)
+{
+    free(match->moves);
+    free(match->timings);
+    memset(match, 0, sizeof(MatchStats));
+}
+
+int statsRecordMove(MatchStats *match, int ply, int alg, const SearchReport *report)
+{
+    addSearchStats(&match->total, &report->stats);
+    match->seconds += report->seconds;
+
+    if (match->count == match->capacity) {
+        int capacity = match->capacity ? match->capacity * 2 : 64;
+        MoveStats *moves = (MoveStats *) realloc(match->moves, capacity * sizeof(MoveStats));
+        if (moves == NULL) {
+            return FALSE;
+        }
+        match->moves = moves;
+        match->capacity = capacity;
+    }
+
+    MoveStats *move = &match->moves[match->count++];
+    move->ply = ply;
+    move->alg = alg;
+    move->depth = report->depth;
+    move->stats = report->stats;
+    move->seconds = report->seconds;
+    return TRUE;
+}
+
+void statsPrintSearch(FILE *out, const SearchReport *report)
+{
+    const SearchStats *s = &report->stats;
+
+    fprintf(out, "Search: depth %d, %llu nodes, %llu leaves, EBF %.2f, %llu cutoffs (%.1f%% first move), "
+        "TT hits %.1f%%, %.3f s, %.0f nodes/s\n",
+        report->depth, s->nodes, s->leaves, effectiveBranchingFactor(s->nodes, report->depth), s->cutoffs,
+        percent(s->firstCutoffs, s->cutoffs), percent(s->ttHits, s->ttProbes), report->seconds,
+        nodesPerSecond(s->nodes, report->seconds));
+}
+
+void statsPrintMatch(FILE *out, const MatchStats *match)
+{
+    const SearchStats *s = &match->total;
+    double depth = 0, ebf = 0;
+
+    if (match->count == 0) {
+        return;
+    }
+    // the branching factor of a game is the average of its moves, the deep searches would hide the others
+    for (int i = 0; i < match->count; i++) {
+        depth += match->moves[i].depth;
+        ebf += effectiveBranchingFactor(match->moves[i].stats.nodes, match->moves[i].depth);
+    }
+
+    fprintf(out, "Searches: %d, average depth %.1f, average EBF %.2f\n", match->count, depth / match->count, ebf / match->count);
+    fprintf(out, "Nodes: %llu in %.3f s, %.0f nodes/s, %llu leaves\n", s->nodes, match->seconds,
+        nodesPerSecond(s->nodes, match->seconds), s->leaves);
+    fprintf(out, "Cutoffs: %llu, %.1f%% on the first move\n", s->cutoffs, percent(s->firstCutoffs, s->cutoffs));
+    fprintf(out, "TT: %llu probes, %.1f%% hits\n", s->ttProbes, percent(s->ttHits, s->ttProbes));
+}
+
+void statsSplitSearch(MoveTiming *timing, const SearchReport *report, double seconds, int threads)
+{
+    double phases = 0;
+
+    if (report != NULL) {
+        for (int p = 0; p < NUM_SEARCH_PHASES; p++) {
+            timing->seconds[p] = searchPhaseSeconds(&report->stats, p) / (threads > 1 ? threads : 1);
+            phases += timing->seconds[p];
+        }
+    }
+    // the phases are estimated from samples, if they add up to more than the whole they are scaled down to it
+    if (phases > seconds) {
+        for (int p = 0; p < NUM_SEARCH_PHASES; p++) {
+            timing->seconds[p] *= seconds / phases;
+        }
+        phases = seconds;
+    }
+    timing->seconds[MOVE_PHASE_SEARCH] = seconds - phases;
+}
+
+int statsRecordTiming(MatchStats *match, const MoveTiming *timing)
+{
+    if (match->timingCount == match->timingCapacity) {
+        int capacity = match->timingCapacity ? match->timingCapacity * 2 : 64;
+        MoveTiming *timings = (MoveTiming *) realloc(match->timings, capacity * sizeof(MoveTiming));
+        if (timings == NULL) {
+            return FALSE;
+        }
+        match->timings = timings;
+        match->timingCapacity = capacity;
+    }
+    match->timings[match->timingCount++] = *timing;
+    return TRUE;
+}
+
+static int compareSeconds(const void *a, const void *b)
+{
+    double x = *(const double *) a;
+    double y = *(const double *) b;
+    return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+/**
+ * The nearest rank percentile of the sorted values: the smallest one with at least percent% of them at or below it
+ */
+static double percentile(const double *sorted, int count, int percent)
+{
+    int rank = (percent * count + 99) / 100;
+    return sorted[rank > 0 ? rank - 1 : 0];
+}
+
+void statsPrintTiming(FILE *out, const MatchStats *match)
+{
+    static const char *phaseNames[NUM_MOVE_PHASES] = {
+        "movegen", "eval", "ordering", "search", "send", "print", "move"
+    };
+    int count = match->timingCount;
+
+    if (count == 0) {
+        return;
+    }
+    double *sorted = (double *) malloc(count * sizeof(double));
+    if (sorted == NULL) {
+        return;
+    }
+
+    fprintf(out, "Latency over %d moves (ms)   p50       p95       p99       max\n", count);
+    for (int p = 0; p < NUM_MOVE_PHASES; p++) {
+        for (int i = 0; i < count; i++) {
+            sorted[i] = match->timings[i].seconds[p];
+        }
+        qsort(sorted, count, sizeof(double), compareSeconds);
+        fprintf(out, "  %-24s %9.3f %9.3f %9.3f %9.3f\n", phaseNames[p], 1000 * percentile(sorted, count, 50),
+            1000 * percentile(sorted, count, 95), 1000 * percentile(sorted, count, 99), 1000 * sorted[count - 1]);
+    }
+    free(sorted);
+}
+
+static void writeCsvRow(FILE *file, const char *ply, const char *alg, int depth, const SearchStats *s, double seconds)
+{
+    fprintf(file, "%s,%s,%d,%llu,%llu,%llu,%llu,%llu,%llu,%.4f,%.6f,%.0f\n", ply, alg, depth, s->nodes, s->leaves,
+        s->cutoffs, s->firstCutoffs, s->ttProbes, s->ttHits, effectiveBranchingFactor(s->nodes, depth), seconds,
+        nodesPerSecond(s->nodes, seconds));
+}
+
+static void writeJsonStats(FILE *file, int depth, const SearchStats *s, double seconds)
+{
+    fprintf(file, "\"depth\": %d, \"nodes\": %llu, \"leaves\": %llu, \"cutoffs\": %llu, \"first_cutoffs\": %llu, "
+        "\"tt_probes\": %llu, \"tt_hits\": %llu, \"ebf\": %.4f, \"seconds\": %.6f, \"nps\": %.0f", depth, s->nodes,
+        s->leaves, s->cutoffs, s->firstCutoffs, s->ttProbes, s->ttHits, effectiveBranchingFactor(s->nodes, depth),
+        seconds, nodesPerSecond(s->nodes, seconds));
+}
+
+int statsWriteFile(const MatchStats *match, const char *path, const char * const *algorithmNames)
+{
+    size_t length = strlen(path);
+    int json = length >= 5 && strcmp(path + length - 5, ".json") == 0;
+    FILE *file = fopen(path, "w");
+
+    if (file == NULL) {
+        return FALSE;
+    }
+
+    if (json) {
+        fprintf(file, "{\n  \"moves\": [\n");
+        for (int i = 0; i < match->count; i++) {
+            const MoveStats *m = &match->moves[i];
+            fprintf(file, "    {\"ply\": %d, \"algorithm\": \"%s\", ", m->ply, algorithmNames[m->alg]);
+            writeJsonStats(file, m->depth, &m->stats, m->seconds);
+            fprintf(file, "}%s\n", i + 1 < match->count ? "," : "");
+        }
+        // the total has no depth of its own
+        fprintf(file, "  ],\n  \"total\": {");
+        writeJsonStats(file, 0, &match->total, match->seconds);
+        fprintf(file, "}\n}\n");
+    } else {
+        char ply[16];
+        fprintf(file, "ply,algorithm,depth,nodes,leaves,cutoffs,first_cutoffs,tt_probes,tt_hits,ebf,seconds,nps\n");
+        for (int i = 0; i < match->count; i++) {
+            const MoveStats *m = &match->moves[i];
+            snprintf(ply, sizeof(ply), "%d", m->ply);
+            writeCsvRow(file, ply, algorithmNames[m->alg], m->depth, &m->stats, m->seconds);
+        }
+        writeCsvRow(file, "total", "", 0, &match->total, match->seconds);
+    }
+
+    return fclose(file) == 0;
+}
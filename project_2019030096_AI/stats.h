@@ -0,0 +1,72 @@
+#ifndef _STATS_H
+#define _STATS_H
+
+#include "search.h"
+#include <stdio.h>
+
+/**********************************************************/
+
+/* The phases of one of our moves, timed with the monotonic clock. The first ones are the parts of the search */
+#define MOVE_PHASE_MOVEGEN SEARCH_PHASE_MOVEGEN
+#define MOVE_PHASE_EVAL SEARCH_PHASE_EVAL
+#define MOVE_PHASE_ORDERING SEARCH_PHASE_ORDERING
+#define MOVE_PHASE_SEARCH 3        // the rest of choosing the move: the tree walk, the book
+#define MOVE_PHASE_SEND 4
+#define MOVE_PHASE_PRINT 5         // the board after our move
+#define MOVE_PHASE_TOTAL 6         // from the request of the server until the move is sent, what the server waits for
+#define NUM_MOVE_PHASES 7
+
+/* Seconds of every phase of one move */
+typedef struct {
+    double seconds[NUM_MOVE_PHASES];
+} MoveTiming;
+
+/* One move of the game that was searched (book moves and passes are not) */
+typedef struct {
+    int ply;                       // our move number in the game, from 1
+    int alg;
+    int depth;
+    SearchStats stats;
+    double seconds;
+} MoveStats;
+
+/* The searches of a whole game, for the report at the end and the -S file */
+typedef struct {
+    MoveStats *moves;
+    int count;
+    int capacity;
+    SearchStats total;
+    double seconds;
+    MoveTiming *timings;           // every move, the book moves and passes too
+    int timingCount;
+    int timingCapacity;
+} MatchStats;
+
+/**********************************************************/
+
+void statsInit(MatchStats *match);
+void statsFree(MatchStats *match);
+
+int statsRecordMove(MatchStats *match, int ply, int alg, const SearchReport *report);
+// adds the search of one move, returns FALSE if there was no memory for it (the totals still count it)
+
+void statsPrintSearch(FILE *out, const SearchReport *report);
+// one line with the counters of a search: nodes, leaves, cutoffs, effective branching factor, TT hits, nodes/s
+
+void statsPrintMatch(FILE *out, const MatchStats *match);
+// the same counters for the whole game
+
+void statsSplitSearch(MoveTiming *timing, const SearchReport *report, double seconds, int threads);
+// splits the seconds it took to choose the move between the phases of the search in report (NULL if there was
+// no search), the threads share the time of their phases
+
+int statsRecordTiming(MatchStats *match, const MoveTiming *timing);
+// adds the phases of one move, returns FALSE if there was no memory for it
+
+void statsPrintTiming(FILE *out, const MatchStats *match);
+// the median, 95th and 99th percentile and the maximum of every phase over the moves of the game
+
+int statsWriteFile(const MatchStats *match, const char *path, const char * const *algorithmNames);
+// writes every move and the totals, as JSON if path ends in .json and else as CSV. Returns FALSE on errors
+
+#endif
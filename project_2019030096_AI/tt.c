@@ -0,0 +1,176 @@
+#include "tt.h"
+#include <stdlib.h>
+#include <string.h>
+
+
+/* Layout of TTEntry.data. The search never stores depth 0, so data == 0 is an empty entry */
+#define SCORE_SHIFT 0			//16 bits, score + SCORE_BIAS
+#define DEPTH_SHIFT 16			//8 bits
+#define BOUND_SHIFT 24			//2 bits
+#define HAS_MOVE_SHIFT 26		//1 bit
+#define ROW_SHIFT 32			//8 bits
+#define COL_SHIFT 40			//8 bits
+#define GENERATION_SHIFT 48		//8 bits
+
+#define SCORE_BIAS 32768
+
+#define FIELD( data, shift, bits ) ( (int) ( ( ( data ) >> ( shift ) ) & ( ( 1ULL << ( bits ) ) - 1 ) ) )
+
+/* The table is shared by the search threads without locks. An entry keeps hash ^ data instead of the hash,
+ * so an entry written by two threads at once (key of one, data of the other) does not match any position.
+ * The words are read and written with relaxed atomics, which cost the same as plain loads and stores */
+#define LOAD( word ) __atomic_load_n( &( word ), __ATOMIC_RELAXED )
+#define STORE( word, value ) __atomic_store_n( &( word ), ( value ), __ATOMIC_RELAXED )
+
+
+/**********************************************************/
+static uint64_t packData( int depth, int bound, int score, Move * bestMove, unsigned char generation )
+{
+	uint64_t data = 0;
+
+	data |= (uint64_t) ( score + SCORE_BIAS ) << SCORE_SHIFT;
+	data |= (uint64_t) depth << DEPTH_SHIFT;
+	data |= (uint64_t) bound << BOUND_SHIFT;
+	data |= (uint64_t) generation << GENERATION_SHIFT;
+
+	if( bestMove != NULL && bestMove->tile[ 0 ] != NULL_MOVE )
+	{
+		data |= 1ULL << HAS_MOVE_SHIFT;
+		data |= (uint64_t) (unsigned char) bestMove->tile[ 0 ] << ROW_SHIFT;
+		data |= (uint64_t) (unsigned char) bestMove->tile[ 1 ] << COL_SHIFT;
+	}
+
+	return data;
+}
+
+/**********************************************************/
+static void unpackData( uint64_t data, TTData * out )
+{
+	out->score = FIELD( data, SCORE_SHIFT, 16 ) - SCORE_BIAS;
+	out->depth = FIELD( data, DEPTH_SHIFT, 8 );
+	out->bound = FIELD( data, BOUND_SHIFT, 2 );
+
+	if( FIELD( data, HAS_MOVE_SHIFT, 1 ) )
+	{
+		out->bestMove.tile[ 0 ] = (signed char) FIELD( data, ROW_SHIFT, 8 );
+		out->bestMove.tile[ 1 ] = (signed char) FIELD( data, COL_SHIFT, 8 );
+	}
+	else
+		out->bestMove.tile[ 0 ] = NULL_MOVE;
+}
+
+/**********************************************************/
+int ttInit( TranspositionTable * tt, int megabytes )
+{
+	uint64_t bytes = (uint64_t) megabytes << 20;
+	uint64_t count = 1;
+
+	/* the largest power of 2 of buckets that fits */
+	while( count * 2 * sizeof( TTBucket ) <= bytes )
+		count *= 2;
+
+	tt->buckets = aligned_alloc( TT_CACHE_LINE, count * sizeof( TTBucket ) );
+	if( tt->buckets == NULL )
+		return FALSE;
+
+	tt->mask = count - 1;
+	tt->generation = 0;
+	ttClear( tt );
+
+	return TRUE;
+}
+
+/**********************************************************/
+void ttFree( TranspositionTable * tt )
+{
+	free( tt->buckets );
+	tt->buckets = NULL;
+	tt->mask = 0;
+}
+
+/**********************************************************/
+void ttClear( TranspositionTable * tt )
+{
+	memset( tt->buckets, 0, ( tt->mask + 1 ) * sizeof( TTBucket ) );
+}
+
+/**********************************************************/
+void ttNewSearch( TranspositionTable * tt )
+{
+	tt->generation++;
+}
+
+/**********************************************************/
+int ttProbe( TranspositionTable * tt, uint64_t hash, TTData * data )
+{
+	TTBucket * bucket = &tt->buckets[ hash & tt->mask ];
+	int i;
+
+	for( i = 0; i < TT_BUCKET_SIZE; i++ )
+	{
+		uint64_t entryData = LOAD( bucket->entry[ i ].data );
+
+		if( ( LOAD( bucket->entry[ i ].key ) ^ entryData ) == hash && entryData != 0 )
+		{
+			unpackData( entryData, data );
+			return TRUE;
+		}
+	}
+
+	return FALSE;
+}
+
+/**********************************************************/
+void ttStore( TranspositionTable * tt, uint64_t hash, int depth, int bound, int score, Move * bestMove )
+{
+	TTBucket * bucket = &tt->buckets[ hash & tt->mask ];
+	TTEntry * replace = NULL;
+	uint64_t data;
+	int i, replaceDepth = 0;
+
+	/* the position is already in the bucket: keep its slot. A shallower search of this generation that did not find
+	 * the exact value (a helper thread one ply behind, a null window before the re-search) does not replace a
+	 * deeper result, it only gives its best move */
+	for( i = 0; i < TT_BUCKET_SIZE; i++ )
+	{
+		uint64_t old = LOAD( bucket->entry[ i ].data );
+
+		if( ( LOAD( bucket->entry[ i ].key ) ^ old ) != hash || old == 0 )
+			continue;
+
+		replace = &bucket->entry[ i ];
+		if( depth < FIELD( old, DEPTH_SHIFT, 8 ) && bound != TT_EXACT && FIELD( old, GENERATION_SHIFT, 8 ) == tt->generation )
+		{
+			if( bestMove == NULL || bestMove->tile[ 0 ] == NULL_MOVE )
+				return;
+			depth = FIELD( old, DEPTH_SHIFT, 8 );
+			bound = FIELD( old, BOUND_SHIFT, 2 );
+			score = FIELD( old, SCORE_SHIFT, 16 ) - SCORE_BIAS;
+		}
+		break;
+	}
+
+	if( replace == NULL )
+	{
+		/* the shallowest of the depth-preferred slots, entries of older searches count as empty */
+		for( i = 0; i < TT_DEPTH_SLOTS; i++ )
+		{
+			uint64_t data = LOAD( bucket->entry[ i ].data );
+			int slotDepth = FIELD( data, GENERATION_SHIFT, 8 ) == tt->generation ? FIELD( data, DEPTH_SHIFT, 8 ) : 0;
+
+			if( replace == NULL || slotDepth < replaceDepth )
+			{
+				replace = &bucket->entry[ i ];
+				replaceDepth = slotDepth;
+			}
+		}
+
+		/* not deep enough to push out a deeper search, it goes to the always-replace slot */
+		if( depth < replaceDepth )
+			replace = &bucket->entry[ TT_DEPTH_SLOTS ];
+	}
+
+	data = packData( depth, bound, score, bestMove, tt->generation );
+	STORE( replace->key, hash ^ data );
+	STORE( replace->data, data );
+}
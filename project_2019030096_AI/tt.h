@@ -0,0 +1,74 @@
+#ifndef _TT_H
+#define _TT_H
+
+#include "global.h"
+#include "move.h"
+#include <stdint.h>
+
+/**********************************************************/
+
+/* What the score of an entry means */
+#define TT_EXACT 0			//the score is the value of the position
+#define TT_LOWER 1			//the search failed high, the value is at least score
+#define TT_UPPER 2			//the search failed low, the value is at most score
+
+/* A bucket fills one cache line: TT_DEPTH_SLOTS entries that keep the deepest searches
+ * and one that always takes the newest search that did not fit in them */
+#define TT_BUCKET_SIZE 4
+#define TT_DEPTH_SLOTS ( TT_BUCKET_SIZE - 1 )
+#define TT_CACHE_LINE 64
+
+/* Default size of the table in MB (the -H option) */
+#define TT_DEFAULT_MB 16
+
+/* One entry, data holds the fields of TTData packed in 64 bits and key is hash ^ data (see tt.c) */
+typedef struct
+{
+	uint64_t key;
+	uint64_t data;
+} TTEntry;
+
+typedef struct
+{
+	TTEntry entry[ TT_BUCKET_SIZE ];
+} __attribute__( ( aligned( TT_CACHE_LINE ) ) ) TTBucket;
+
+typedef struct
+{
+	TTBucket * buckets;
+	uint64_t mask;					//number of buckets - 1, the count is a power of 2
+	unsigned char generation;		//increased by every search, entries of older searches are replaced first
+} TranspositionTable;
+
+/* The fields of an entry as the search uses them */
+typedef struct
+{
+	int depth;
+	int bound;
+	int score;
+	Move bestMove;					//tile[ 0 ] == NULL_MOVE if the entry has no move
+} TTData;
+
+/**********************************************************/
+
+int ttInit( TranspositionTable * tt, int megabytes );
+//allocates an empty table of (at most) megabytes MB, returns FALSE if there is not enough memory
+//ttProbe() and ttStore() can be called by several threads at once, the other functions cannot
+
+void ttFree( TranspositionTable * tt );
+//releases the memory of the table
+
+void ttClear( TranspositionTable * tt );
+//empties the table
+
+void ttNewSearch( TranspositionTable * tt );
+//marks the entries stored so far as old, call once before each search
+
+int ttProbe( TranspositionTable * tt, uint64_t hash, TTData * data );
+//looks for the position with key hash, returns TRUE and fills data if it is in the table
+
+void ttStore( TranspositionTable * tt, uint64_t hash, int depth, int bound, int score, Move * bestMove );
+//stores the result of a search of the position with key hash (bestMove can be NULL). A deeper entry of the same
+//search for the position is kept unless the new result is exact, only its best move is updated
+
+#endif
@@ -0,0 +1,427 @@
+#include "ybwc.h"
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+
+
+static int searchMoves(YbwcContext *ctx, MoveList *list, int depth, int alpha, int beta, int *bestIndex);
+
+/**
+ * Deque of a worker, all under the worker's lock.
+ * The deque restarts from the beginning every time it becomes empty
+ */
+static int pushTasks(YbwcWorker *worker, SplitPoint *sp, int first, int last)
+{
+    int pushed = FALSE;
+
+    pthread_mutex_lock(&worker->lock);
+    if (worker->bottom + (last - first + 1) <= YBWC_DEQUE_SIZE) {
+        // pushed from the last child, so the owner pops them in order and the thieves take the last ones
+        for (int i = last; i >= first; i--) {
+            worker->tasks[worker->bottom].sp = sp;
+            worker->tasks[worker->bottom].index = i;
+            worker->bottom++;
+        }
+        pushed = TRUE;
+    }
+    pthread_mutex_unlock(&worker->lock);
+    return pushed;
+}
+
+static int popTask(YbwcWorker *worker, YbwcTask *task)
+{
+    int found = FALSE;
+
+    pthread_mutex_lock(&worker->lock);
+    if (worker->bottom > worker->top) {
+        *task = worker->tasks[--worker->bottom];
+        found = TRUE;
+        if (worker->bottom == worker->top) {
+            worker->bottom = worker->top = 0;
+        }
+    }
+    pthread_mutex_unlock(&worker->lock);
+    return found;
+}
+
+static int stealTask(YbwcWorker *victim, YbwcTask *task)
+{
+    int found = FALSE;
+
+    pthread_mutex_lock(&victim->lock);
+    if (victim->bottom > victim->top) {
+        *task = victim->tasks[victim->top++];
+        found = TRUE;
+        if (victim->bottom == victim->top) {
+            victim->bottom = victim->top = 0;
+        }
+    }
+    pthread_mutex_unlock(&victim->lock);
+    return found;
+}
+
+/**
+ * Takes a task for worker: its own newest one, else the oldest one of another worker
+ */
+static int findTask(YbwcWorker *worker, YbwcTask *task)
+{
+    YbwcPool *pool = worker->pool;
+
+    // no free context to run it in
+    if (worker->level >= YBWC_MAX_NESTING) {
+        return FALSE;
+    }
+    if (popTask(worker, task)) {
+        return TRUE;
+    }
+    for (int i = 1; i < pool->count; i++) {
+        if (stealTask(&pool->workers[(worker->index + i) % pool->count], task)) {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+/**
+ * TRUE if the search of ctx has to stop: the time is over or some split point above it had a cutoff
+ */
+static int mustStop(YbwcContext *ctx)
+{
+    YbwcPool *pool = ctx->worker->pool;
+
+    if ((ctx->worker->stats.nodes & (SEARCH_CHECK_NODES - 1)) == 0 && pool->deadline > 0 && getTimeSeconds() >= pool->deadline) {
+        __atomic_store_n(&pool->stop, TRUE, __ATOMIC_RELAXED);
+    }
+    if (__atomic_load_n(&pool->stop, __ATOMIC_RELAXED)) {
+        return TRUE;
+    }
+    for (SplitPoint *sp = ctx->split; sp != NULL; sp = sp->parent) {
+        if (__atomic_load_n(&sp->cutoff, __ATOMIC_RELAXED)) {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+/**
+ * Negamax with alpha-beta, like negamax() but the moves are ordered and big nodes are split between the threads
+ */
+static int ybwcNode(YbwcContext *ctx, int depth, int alpha, int beta)
+{
+    Position *pos = &ctx->info.pos;
+    char currentPlayer = pos->turn;
+
+    ctx->worker->stats.nodes++;
+    if (ctx->info.aborted || mustStop(ctx)) {
+        ctx->info.aborted = TRUE;
+        return 0;
+    }
+
+    // leaf of the search, value for the player to move
+    if (depth == 0) {
+        ctx->info.reachedDepthLimit = TRUE;
+        COUNT_STAT(&ctx->worker->stats, leaves);
+        int value;
+        TIME_PHASE(&ctx->worker->stats, SEARCH_PHASE_EVAL, value = evaluatePosition(pos, currentPlayer));
+        return value;
+    }
+
+    BitBoard mobility[2];
+    TIME_PHASE(&ctx->worker->stats, SEARCH_PHASE_MOVEGEN, getMobility(pos, mobility));
+
+    // terminal position, nobody can move
+    if (bbIsEmpty(mobility[WHITE]) && bbIsEmpty(mobility[BLACK])) {
+        COUNT_STAT(&ctx->worker->stats, leaves);
+        int value;
+        TIME_PHASE(&ctx->worker->stats, SEARCH_PHASE_EVAL, value = evaluatePosition(pos, currentPlayer));
+        return value;
+    }
+
+    // we cannot move but the other player can, pass the turn
+    if (bbIsEmpty(mobility[(int) currentPlayer])) {
+        Move passMove;
+        passMove.tile[0] = NULL_MOVE;
+        passMove.color   = currentPlayer;
+        makeMove(pos, &passMove, &ctx->info.undo);
+        int value = -ybwcNode(ctx, depth-1, -beta, -alpha);
+        unmakeMove(pos, &ctx->info.undo);
+        return value;
+    }
+
+    MoveList list;
+    TIME_PHASE(&ctx->worker->stats, SEARCH_PHASE_MOVEGEN, generateMovesFromSet(pos, currentPlayer, mobility[(int) currentPlayer], &list));
+    TIME_PHASE(&ctx->worker->stats, SEARCH_PHASE_ORDERING, orderMovesByFlips(&list));
+
+    int bestIndex;
+    return searchMoves(ctx, &list, depth, alpha, beta, &bestIndex);
+}
+
+/**
+ * Runs one task of a split point in a free context of worker and reports its value to the split point
+ */
+static void runTask(YbwcWorker *worker, YbwcTask *task)
+{
+    SplitPoint *sp = task->sp;
+    YbwcContext *ctx = &worker->slots[worker->level++];
+
+    memcpy(&ctx->info.pos, &sp->pos, sizeof(Position));
+    initUndoStack(&ctx->info.undo);
+    ctx->info.aborted = FALSE;
+    ctx->info.reachedDepthLimit = FALSE;
+    ctx->split = sp;
+
+    // the window of the split point as it is now, earlier tasks may have raised alpha
+    pthread_mutex_lock(&sp->lock);
+    int alpha = sp->alpha;
+    int beta  = sp->beta;
+    pthread_mutex_unlock(&sp->lock);
+
+    int value = 0;
+    if (!mustStop(ctx)) {
+        makeGeneratedMove(&ctx->info.pos, &sp->moves->moves[task->index], &ctx->info.undo);
+        value = -ybwcNode(ctx, sp->depth-1, -beta, -alpha);
+    } else {
+        ctx->info.aborted = TRUE;
+    }
+
+    if (ctx->info.reachedDepthLimit) {
+        __atomic_store_n(&worker->pool->reachedDepthLimit, TRUE, __ATOMIC_RELAXED);
+    }
+
+    pthread_mutex_lock(&sp->lock);
+    if (!ctx->info.aborted) {
+        if (value > sp->bestVal) {
+            sp->bestVal = value;
+            sp->bestIndex = task->index;
+        }
+        if (value > sp->alpha) {
+            sp->alpha = value;
+        }
+        if (sp->alpha >= sp->beta) {
+            COUNT_CUTOFF(&worker->stats, task->index);
+            __atomic_store_n(&sp->cutoff, TRUE, __ATOMIC_RELAXED);
+        }
+    }
+    pthread_mutex_unlock(&sp->lock);
+
+    // the owner of the split point waits for this, so it goes last
+    worker->level--;
+    __atomic_fetch_sub(&sp->pending, 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * Searches the children list->moves[first..] of the node of ctx in all the threads.
+ * The owner runs tasks (its own first) until every child of the split point is done
+ */
+static int splitNode(YbwcContext *ctx, MoveList *list, int first, int depth, int alpha, int beta, int *bestVal, int *bestIndex)
+{
+    SplitPoint sp;
+
+    pthread_mutex_init(&sp.lock, NULL);
+    sp.parent = ctx->split;
+    memcpy(&sp.pos, &ctx->info.pos, sizeof(Position));
+    sp.moves = list;
+    sp.depth = depth;
+    sp.beta = beta;
+    sp.alpha = alpha;
+    sp.bestVal = *bestVal;
+    sp.bestIndex = *bestIndex;
+    sp.cutoff = FALSE;
+    sp.pending = list->count - first;
+
+    if (!pushTasks(ctx->worker, &sp, first, list->count - 1)) {
+        pthread_mutex_destroy(&sp.lock);
+        return FALSE;
+    }
+
+    while (__atomic_load_n(&sp.pending, __ATOMIC_ACQUIRE) > 0) {
+        YbwcTask task;
+        if (findTask(ctx->worker, &task)) {
+            runTask(ctx->worker, &task);
+        } else {
+            sched_yield();
+        }
+    }
+
+    *bestVal = sp.bestVal;
+    *bestIndex = sp.bestIndex;
+
+    // a cutoff above us may have stopped the tasks, then the values are not complete
+    if (mustStop(ctx)) {
+        ctx->info.aborted = TRUE;
+    }
+
+    pthread_mutex_destroy(&sp.lock);
+    return TRUE;
+}
+
+/**
+ * Searches the ordered moves of the node of ctx: the eldest child alone, then the others in parallel when
+ * the node is big enough and there are other threads (else one after the other, as negamax() does)
+ */
+static int searchMoves(YbwcContext *ctx, MoveList *list, int depth, int alpha, int beta, int *bestIndex)
+{
+    Position *pos = &ctx->info.pos;
+    int bestVal = -SEARCH_INFINITY;
+
+    *bestIndex = -1;
+    for (int i = 0; i < list->count; i++) {
+        // the young brothers wait for the eldest one, then they can be split
+        if (i > 0 && depth >= YBWC_MIN_SPLIT_DEPTH && ctx->worker->pool->count > 1
+            && splitNode(ctx, list, i, depth, alpha, beta, &bestVal, bestIndex)) {
+            break;
+        }
+
+        makeGeneratedMove(pos, &list->moves[i], &ctx->info.undo);
+        int value = -ybwcNode(ctx, depth-1, -beta, -alpha);
+        unmakeMove(pos, &ctx->info.undo);
+
+        if (ctx->info.aborted) {
+            return 0;
+        }
+        if (value > bestVal) {
+            bestVal = value;
+            *bestIndex = i;
+        }
+        if (value > alpha) {
+            alpha = value;
+        }
+        if (alpha >= beta) {
+            COUNT_CUTOFF(&ctx->worker->stats, i);
+            break;
+        }
+    }
+    return ctx->info.aborted ? 0 : bestVal;
+}
+
+/**
+ * The helpers take tasks until the search is over
+ */
+static void *helperLoop(void *arg)
+{
+    YbwcWorker *worker = (YbwcWorker *) arg;
+
+    while (!__atomic_load_n(&worker->pool->done, __ATOMIC_ACQUIRE)) {
+        YbwcTask task;
+        if (findTask(worker, &task)) {
+            runTask(worker, &task);
+        } else {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+Move ybwcSearch(Position *rootPos, const SearchOptions *options, SearchReport *report)
+{
+    YbwcPool pool;
+    double start = getTimeSeconds();
+
+    Move bestMove;
+    bestMove.tile[0] = NULL_MOVE;
+    bestMove.color   = rootPos->turn;
+
+    if (report != NULL) {
+        report->depth = 0;
+        report->score = 0;
+    }
+
+    pool.count = options->threads > 1 ? options->threads : 1;
+    pool.done = FALSE;
+    pool.reachedDepthLimit = FALSE;
+    pool.stop = FALSE;
+    pool.deadline = options->timeLimitMs > 0 ? start + options->timeLimitMs / 1000.0 : 0;
+    pool.workers = (YbwcWorker *) calloc(pool.count, sizeof(YbwcWorker));
+    if (pool.workers == NULL) {
+        return bestMove;
+    }
+
+    int ready = 0;
+    for (; ready < pool.count; ready++) {
+        YbwcWorker *worker = &pool.workers[ready];
+        worker->slots = (YbwcContext *) malloc(YBWC_MAX_NESTING * sizeof(YbwcContext));
+        if (worker->slots == NULL) {
+            break;
+        }
+        pthread_mutex_init(&worker->lock, NULL);
+        worker->index = ready;
+        worker->pool = &pool;
+        for (int i = 0; i < YBWC_MAX_NESTING; i++) {
+            worker->slots[i].worker = worker;
+        }
+    }
+    // search with the threads we could prepare
+    pool.count = ready;
+
+    // the root search runs in the first context of the main thread
+    YbwcWorker *mainWorker = &pool.workers[0];
+    YbwcContext *root = &mainWorker->slots[mainWorker->level++];
+    memcpy(&root->info.pos, rootPos, sizeof(Position));
+    initUndoStack(&root->info.undo);
+    root->info.aborted = FALSE;
+    root->split = NULL;
+
+    MoveList list;
+    generateMoves(&root->info.pos, root->info.pos.turn, &list);
+    orderMovesByFlips(&list);
+
+    int started = 1;
+    if (list.count > 0) {
+        // if not even depth 1 finishes we still play a legal move
+        bestMove = list.moves[0].move;
+
+        while (started < pool.count && pthread_create(&pool.workers[started].thread, NULL, helperLoop, &pool.workers[started]) == 0) {
+            started++;
+        }
+        pool.count = started;
+
+        for (int depth = 1; depth <= options->maxDepth; depth++) {
+            root->info.reachedDepthLimit = FALSE;
+            pool.reachedDepthLimit = FALSE;
+
+            int bestIndex;
+            int score = searchMoves(root, &list, depth, -SEARCH_INFINITY, SEARCH_INFINITY, &bestIndex);
+            if (root->info.aborted || bestIndex < 0) {
+                break;
+            }
+            bestMove = list.moves[bestIndex].move;
+            if (report != NULL) {
+                report->depth = depth;
+                report->score = score;
+            }
+
+            // the next iteration starts with the best move, the order of the others stays the same
+            GeneratedMove best = list.moves[bestIndex];
+            memmove(&list.moves[1], &list.moves[0], bestIndex * sizeof(GeneratedMove));
+            list.moves[0] = best;
+
+            // every line reached the end of the game, deeper iterations would find the same
+            if (!root->info.reachedDepthLimit && !pool.reachedDepthLimit) {
+                break;
+            }
+            if (pool.deadline > 0 && getTimeSeconds() - start > (pool.deadline - start) / 2) {
+                break;
+            }
+        }
+
+        __atomic_store_n(&pool.done, TRUE, __ATOMIC_RELEASE);
+        for (int i = 1; i < started; i++) {
+            pthread_join(pool.workers[i].thread, NULL);
+        }
+    }
+
+    if (report != NULL) {
+        memset(&report->stats, 0, sizeof(SearchStats));
+        for (int i = 0; i < ready; i++) {
+            addSearchStats(&report->stats, &pool.workers[i].stats);
+        }
+        report->seconds = getTimeSeconds() - start;
+    }
+
+    for (int i = 0; i < ready; i++) {
+        pthread_mutex_destroy(&pool.workers[i].lock);
+        free(pool.workers[i].slots);
+    }
+    free(pool.workers);
+    return bestMove;
+}
@@ -0,0 +1,74 @@
+#ifndef _YBWC_H
+#define _YBWC_H
+
+#include "search.h"
+#include <pthread.h>
+
+/**********************************************************/
+
+#define YBWC_MIN_SPLIT_DEPTH 3		// nodes closer to the leaves are searched by one thread
+#define YBWC_DEQUE_SIZE 1024		// tasks waiting in the deque of one thread
+#define YBWC_MAX_NESTING 32		// tasks one thread can be running inside each other
+
+/**
+ *  A node whose children are searched by several threads (Young Brothers Wait Concept).
+ *  The eldest child is searched first by the owner of the node, then every other child becomes a task
+ *  in the owner's deque. The owner and the idle threads take the tasks and report their values here
+ */
+typedef struct SplitPoint {
+    pthread_mutex_t lock;
+    struct SplitPoint *parent;     // split point of the task the owner was running, a cutoff there stops us too
+    Position pos;                  // position of the node, each task starts from a copy of it
+    MoveList *moves;               // ordered children, on the owner's stack
+    int depth;
+    int beta;
+    int alpha;                     // raised by the finished tasks (under lock)
+    int bestVal;
+    int bestIndex;
+    int cutoff;                    // a child failed high, the other tasks are useless
+    int pending;                   // tasks not finished yet
+} SplitPoint;
+
+typedef struct {
+    SplitPoint *sp;
+    int index;                     // child of sp to search
+} YbwcTask;
+
+struct YbwcPool;
+
+/* The search state of one task, a thread keeps one per nesting level */
+typedef struct {
+    SearchInfo info;
+    SplitPoint *split;             // split point of the task, NULL for the root search
+    struct YbwcWorker *worker;
+} YbwcContext;
+
+/* One search thread with its deque: the owner pushes and pops at the bottom, thieves steal at the top */
+typedef struct YbwcWorker {
+    pthread_mutex_t lock;
+    YbwcTask tasks[YBWC_DEQUE_SIZE];
+    int top;
+    int bottom;
+    int index;
+    SearchStats stats;             // of every context of the thread
+    YbwcContext *slots;            // YBWC_MAX_NESTING contexts
+    int level;                     // slots in use
+    struct YbwcPool *pool;
+    pthread_t thread;
+} YbwcWorker;
+
+typedef struct YbwcPool {
+    YbwcWorker *workers;
+    int count;
+    int done;                      // the search is over, the helpers return
+    int stop;                      // the time is over
+    int reachedDepthLimit;         // a task was cut by the depth (the root context has its own flag)
+    double deadline;               // 0 for no limit
+} YbwcPool;
+
+/**********************************************************/
+
+Move ybwcSearch(Position *rootPos, const SearchOptions *options, SearchReport *report);
+// iterative deepening with a YBWC alpha-beta in options->threads threads (one thread searches alone, always the same way)
+
+#endif